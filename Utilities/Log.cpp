@@ -11,6 +11,56 @@ using namespace Log;
 
 LogManager *gLogManager = nullptr;
 
+namespace Log
+{
+	enum LogRecordKind : u32
+	{
+		RecordMessage,
+		RecordText, // unformatted text (no arguments)
+		RecordThreadName, // following records come from this thread
+		RecordPadding, // unused space till the end of the ring
+	};
+
+	struct LogRecord
+	{
+		u32 size; // size of the whole record, multiple of 8
+		LogRecordKind kind;
+		u64 seq; // global order of the messages
+		LogType type;
+		LogSeverity sev;
+		LogFormatFunc format;
+		//followed by the format string and the arguments
+	};
+
+	//single-producer single-consumer ring of log records
+	struct LogRing
+	{
+		static const u32 size = 0x10000;
+
+		std::atomic<u32> push; // end of the committed records (written by the owner thread)
+		std::atomic<u32> pop; // end of the processed records (written by the writer thread)
+		std::atomic<bool> in_use;
+		u32 reserved; // end of the record being written (owner only)
+		const NamedThreadBase* thread; // thread of the last thread name record (owner only)
+		std::string thread_name; // writer only
+		u8 data[size];
+
+		LogRing()
+			: push(0)
+			, pop(0)
+			, in_use(false)
+			, reserved(0)
+			, thread(nullptr)
+		{
+		}
+
+		//wait for space, returns nullptr if the writer doesn't release enough space
+		u8* reserve(u32 rec_size, LogManager& manager);
+	};
+}
+
+thread_local LogRing* g_tls_log_ring = nullptr;
+
 u32 LogMessage::size() const
 {
 	//1 byte for NULL terminator
@@ -57,9 +107,19 @@ LogChannel::LogChannel() : LogChannel("unknown")
 LogChannel::LogChannel(const std::string& name) :
 	  name(name)
 	, mEnabled(true)
-	, mLogLevel(Warning)
+	, mLogLevel(Success)
 {}
 
+void LogChannel::setEnabled(bool enabled)
+{
+	mEnabled = enabled;
+}
+
+void LogChannel::setLogLevel(LogSeverity level)
+{
+	mLogLevel = level;
+}
+
 void LogChannel::log(const LogMessage &msg)
 {
 	std::lock_guard<std::mutex> lock(mListenerLock);
@@ -115,10 +175,11 @@ struct FileListener : LogListener
 	}
 };
 
-LogManager::LogManager() 
-#ifdef BUFFERED_LOGGING
-	: mExiting(false), mLogConsumer()
-#endif
+LogManager::LogManager()
+	: mSequence(0)
+	, mWakeWriter(false)
+	, mBatches(0)
+	, mExiting(false)
 {
 	auto it = mChannels.begin();
 	std::shared_ptr<LogListener> listener(new FileListener());
@@ -130,44 +191,329 @@ LogManager::LogManager()
 	}
 	std::shared_ptr<LogListener> TTYListener(new FileListener("TTY",false));
 	getChannel(TTY).addListener(TTYListener);
-#ifdef BUFFERED_LOGGING
-	mLogConsumer = std::thread(&LogManager::consumeLog, this);
-#endif
+
+	mWriter = std::thread(&LogManager::writerTask, this);
+
+	//the manager is never destroyed, write the remaining messages on exit
+	std::atexit([]()
+	{
+		if (gLogManager)
+		{
+			gLogManager->stopWriter();
+		}
+	});
 }
 
 LogManager::~LogManager()
 {
-#ifdef BUFFERED_LOGGING
-	mExiting = true;
-	mBufferReady.notify_all();
-	mLogConsumer.join();
+	stopWriter();
+}
+
+void LogManager::stopWriter()
+{
+	if (mExiting.exchange(true))
+	{
+		return;
+	}
+
+	wakeWriter();
+
+	if (mWriter.joinable())
+	{
+		mWriter.join();
+	}
+}
+
+void LogManager::wakeWriter()
+{
+	std::lock_guard<std::mutex> lock(mWriterMutex);
+	mWakeWriter = true;
+	mWriterCond.notify_one();
+}
+
+void LogManager::writerTask()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mWriterMutex);
+			mWriterCond.wait_for(lock, std::chrono::milliseconds(10), [this](){ return mWakeWriter; });
+			mWakeWriter = false;
+		}
+
+		const bool exiting = mExiting;
+
+		while (writeRecords())
+		{
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mWriterMutex);
+			mBatches++;
+		}
+
+		mFlushCond.notify_all();
+
+		if (exiting)
+		{
+			break;
+		}
+	}
+}
+
+bool LogManager::writeRecords()
+{
+	struct Entry
+	{
+		u64 seq;
+		LogRing* ring;
+		const LogRecord* rec;
+
+		bool operator < (const Entry& other) const
+		{
+			return seq < other.seq;
+		}
+	};
+
+	std::vector<LogRing*> rings;
+	{
+		std::lock_guard<std::mutex> lock(mRingsLock);
+		rings = mRings;
+	}
+
+	//collect committed records from all rings and restore their global order
+	std::vector<Entry> entries;
+	std::vector<u32> ends(rings.size());
+
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		LogRing& ring = *rings[i];
+		const u32 end = ring.push.load(std::memory_order_acquire);
+
+		for (u32 pos = ring.pop.load(std::memory_order_relaxed); pos != end;)
+		{
+			const LogRecord* rec = reinterpret_cast<const LogRecord*>(ring.data + pos % LogRing::size);
+
+			if (rec->kind != RecordPadding)
+			{
+				entries.push_back({ rec->seq, &ring, rec });
+			}
+
+			pos += rec->size;
+		}
+
+		ends[i] = end;
+	}
+
+	if (entries.empty())
+	{
+		return false;
+	}
+
+	std::sort(entries.begin(), entries.end());
+
+	for (auto& e : entries)
+	{
+		const char* text = reinterpret_cast<const char*>(e.rec + 1);
+
+		switch (e.rec->kind)
+		{
+		case RecordThreadName:
+			e.ring->thread_name = text;
+			break;
+
+		case RecordText:
+			dispatch({ e.rec->type, e.rec->sev, text }, e.ring->thread_name);
+			break;
+
+		case RecordMessage:
+			dispatch({ e.rec->type, e.rec->sev, e.rec->format(text, reinterpret_cast<const u8*>(text) + strlen(text) + 1) }, e.ring->thread_name);
+			break;
+
+		case RecordPadding:
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		rings[i]->pop.store(ends[i], std::memory_order_release);
+	}
+
+	return true;
+}
+
+LogRing* LogManager::acquireRing()
+{
+	std::lock_guard<std::mutex> lock(mRingsLock);
+
+	for (auto ring : mRings)
+	{
+		if (!ring->in_use)
+		{
+			ring->in_use = true;
+			ring->thread = reinterpret_cast<const NamedThreadBase*>(-1); // force a thread name record
+			return ring;
+		}
+	}
+
+	LogRing* ring = new LogRing();
+	ring->in_use = true;
+	ring->thread = reinterpret_cast<const NamedThreadBase*>(-1);
+	mRings.push_back(ring);
+	return ring;
+}
+
+void LogManager::releaseThreadRing()
+{
+	if (LogRing* ring = g_tls_log_ring)
+	{
+		g_tls_log_ring = nullptr;
+		ring->in_use = false;
+	}
+}
+
+u8* LogRing::reserve(u32 rec_size, LogManager& manager)
+{
+	u32 pos = push.load(std::memory_order_relaxed);
+	const u32 offset = pos % size;
+	const u32 padding = offset + rec_size > size ? size - offset : 0;
+
+	while (pos + padding + rec_size - pop.load(std::memory_order_acquire) > size)
+	{
+		if (manager.isExiting())
+		{
+			return nullptr;
+		}
+
+		//full: wait for the writer
+		manager.flush();
+	}
+
+	if (padding)
+	{
+		LogRecord* rec = reinterpret_cast<LogRecord*>(data + offset);
+		rec->size = padding;
+		rec->kind = RecordPadding;
+		pos += padding;
+	}
+
+	reserved = pos + rec_size;
+	return data + pos % size;
+}
+
+u8* LogManager::beginRecord(LogType type, LogSeverity sev, LogFormatFunc format, const char* fmt, size_t args_size)
+{
+	if (mExiting || std::this_thread::get_id() == mWriter.get_id())
+	{
+		//log directly if the writer can't process it
+		return nullptr;
+	}
+
+	const size_t fmt_size = strlen(fmt) + 1;
+	const size_t rec_size = (sizeof(LogRecord) + fmt_size + args_size + 7) & ~7;
+
+	if (rec_size > LogRing::size / 4)
+	{
+		return nullptr;
+	}
+
+	LogRing* ring = g_tls_log_ring;
+
+	if (!ring)
+	{
+		ring = g_tls_log_ring = acquireRing();
+	}
+
+	const NamedThreadBase* thread = GetCurrentNamedThread();
+
+	if (ring->thread != thread)
+	{
+		const std::string name = thread ? thread->GetThreadName() : "";
+		const u32 name_size = (u32)((sizeof(LogRecord) + name.size() + 1 + 7) & ~7);
+
+		if (name_size <= LogRing::size / 4)
+		{
+			LogRecord* rec = reinterpret_cast<LogRecord*>(ring->reserve(name_size, *this));
+
+			if (!rec)
+			{
+				return nullptr;
+			}
+
+			rec->size = name_size;
+			rec->kind = RecordThreadName;
+			rec->seq = mSequence++;
+			memcpy(rec + 1, name.c_str(), name.size() + 1);
+			ring->push.store(ring->reserved, std::memory_order_release);
+		}
+
+		ring->thread = thread;
+	}
+
+	LogRecord* rec = reinterpret_cast<LogRecord*>(ring->reserve((u32)rec_size, *this));
+
+	if (!rec)
+	{
+		return nullptr;
+	}
+
+	rec->size = (u32)rec_size;
+	rec->kind = format ? RecordMessage : RecordText;
+	rec->seq = mSequence++;
+	rec->type = type;
+	rec->sev = sev;
+	rec->format = format;
+	memcpy(rec + 1, fmt, fmt_size);
+
+	return reinterpret_cast<u8*>(rec + 1) + fmt_size;
+}
+
+void LogManager::endRecord(LogSeverity sev)
+{
+	LogRing* ring = g_tls_log_ring;
+	ring->push.store(ring->reserved, std::memory_order_release);
+
+	if (sev == Error)
+	{
+		//write errors soon without blocking the caller (Emu.Pause() and the exit handler flush the log)
+		wakeWriter();
+	}
 }
 
-void LogManager::consumeLog()
+void LogManager::flush()
 {
-	std::unique_lock<std::mutex> lock(mStatusMut);
-	while (!mExiting)
+	if (mExiting || std::this_thread::get_id() == mWriter.get_id())
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mWriterMutex);
+
+	//the next pass may have started before the caller's records were committed, wait for the one after it
+	const u64 target = mBatches + 2;
+	mWakeWriter = true;
+	mWriterCond.notify_one();
+
+	while (mBatches < target && !mExiting)
 	{
-		mBufferReady.wait(lock);
-		mBuffer.lockGet();
-		size_t size = mBuffer.size();
-		std::vector<char> local_messages(size);
-		mBuffer.popN(&local_messages.front(), size);
-		mBuffer.unlockGet();
+		mFlushCond.wait_for(lock, std::chrono::milliseconds(10));
 
-		u32 cursor = 0;
-		u32 removed = 0;
-		while (cursor < size)
+		if (mBatches < target)
 		{
-			Log::LogMessage msg = Log::LogMessage::deserialize(local_messages.data() + cursor, &removed);
-			cursor += removed;
-			getChannel(msg.mType).log(msg);
+			mWakeWriter = true;
+			mWriterCond.notify_one();
 		}
 	}
-#endif
 }
 
 void LogManager::log(LogMessage msg)
+{
+	NamedThreadBase* thr = GetCurrentNamedThread();
+	dispatch(std::move(msg), thr ? thr->GetThreadName() : "");
+}
+
+void LogManager::dispatch(LogMessage msg, const std::string& thread_name)
 {
 	//don't do any formatting changes or filtering to the TTY output since we
 	//use the raw output to do diffs with the output of a real PS3 and some
@@ -190,22 +536,14 @@ void LogManager::log(LogMessage msg)
 			prefix = "E ";
 			break;
 		}
-		if (NamedThreadBase* thr = GetCurrentNamedThread())
+		if (thread_name.size())
 		{
-			prefix += "{" + thr->GetThreadName() + "} ";
+			prefix += "{" + thread_name + "} ";
 		}
 		msg.mText.insert(0, prefix);
 		msg.mText.append(1,'\n');
 	}
-#ifdef BUFFERED_LOGGING
-	size_t size = msg.size();
-	std::vector<char> temp_buffer(size);
-	msg.serialize(temp_buffer.data());
-	mBuffer.pushRange(temp_buffer.begin(), temp_buffer.end());
-	mBufferReady.notify_one();
-#else
 	mChannels[static_cast<u32>(msg.mType)].log(msg);
-#endif
 }
 
 void LogManager::addListener(std::shared_ptr<LogListener> listener)
@@ -238,14 +576,27 @@ LogChannel &LogManager::getChannel(LogType type)
 
 void log_message(Log::LogType type, Log::LogSeverity sev, const char* text)
 {
-	log_message(type, sev, std::string(text));
-}
+	if (!Log::check_log(type, sev))
+	{
+		return;
+	}
+
+	Log::LogManager& manager = Log::LogManager::getInstance();
+
+	if (manager.beginRecord(type, sev, nullptr, text, 0))
+	{
+		manager.endRecord(sev);
+		return;
+	}
 
-void log_message(Log::LogType type, Log::LogSeverity sev, std::string text)
-{
 	//another msvc bug makes this not work, uncomment this and delete everything else in this function when it's fixed
 	//Log::LogManager::getInstance().log({logType, severity, text})
 
-	Log::LogMessage msg{ type, sev, std::move(text) };
-	Log::LogManager::getInstance().log(msg);
+	Log::LogMessage msg{ type, sev, text };
+	manager.log(msg);
+}
+
+void log_message(Log::LogType type, Log::LogSeverity sev, std::string text)
+{
+	log_message(type, sev, text.c_str());
 }
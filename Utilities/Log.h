@@ -1,14 +1,17 @@
 #pragma once
 #include "Utilities/MTRingbuffer.h"
 
-//#define BUFFERED_LOGGING 1
+//messages below this severity are removed at compile time (arguments aren't evaluated)
+#ifndef LOG_MIN_SEVERITY
+#define LOG_MIN_SEVERITY Log::Success
+#endif
 
 //first parameter is of type Log::LogType and text is of type std::string
 
-#define LOG_SUCCESS(logType, text, ...)           log_message(logType, Log::Success, text, ##__VA_ARGS__)
-#define LOG_NOTICE(logType, text, ...)            log_message(logType, Log::Notice,  text, ##__VA_ARGS__) 
-#define LOG_WARNING(logType, text, ...)           log_message(logType, Log::Warning, text, ##__VA_ARGS__) 
-#define LOG_ERROR(logType, text, ...)             log_message(logType, Log::Error,   text, ##__VA_ARGS__)
+#define LOG_SUCCESS(logType, text, ...)           (Log::Success >= Log::MinSeverity ? log_message(logType, Log::Success, text, ##__VA_ARGS__) : void())
+#define LOG_NOTICE(logType, text, ...)            (Log::Notice  >= Log::MinSeverity ? log_message(logType, Log::Notice,  text, ##__VA_ARGS__) : void())
+#define LOG_WARNING(logType, text, ...)           (Log::Warning >= Log::MinSeverity ? log_message(logType, Log::Warning, text, ##__VA_ARGS__) : void())
+#define LOG_ERROR(logType, text, ...)             (Log::Error   >= Log::MinSeverity ? log_message(logType, Log::Error,   text, ##__VA_ARGS__) : void())
 
 namespace Log
 {
@@ -56,6 +59,9 @@ namespace Log
 		Error,
 	};
 
+	//resolved here because the macro may be expanded after a header defining Success (X11)
+	const LogSeverity MinSeverity = LOG_MIN_SEVERITY;
+
 	struct LogMessage
 	{
 		using size_type = u32;
@@ -83,14 +89,28 @@ namespace Log
 		void log(const LogMessage &msg);
 		void addListener(std::shared_ptr<LogListener> listener);
 		void removeListener(std::shared_ptr<LogListener> listener);
+		void setEnabled(bool enabled);
+		void setLogLevel(LogSeverity level);
+
+		//checked before the message is formatted or buffered
+		bool isEnabled(LogSeverity sev) const
+		{
+			return mEnabled && sev >= mLogLevel;
+		}
+
 		std::string name;
 	private:
-		bool mEnabled;
-		LogSeverity mLogLevel;
+		volatile bool mEnabled;
+		volatile LogSeverity mLogLevel;
 		std::mutex mListenerLock;
 		std::set<std::shared_ptr<LogListener>> mListeners;
 	};
 
+	//formats the arguments stored in a log record
+	typedef std::string(*LogFormatFunc)(const char* fmt, const u8* args);
+
+	struct LogRing;
+
 	struct LogManager
 	{
 		LogManager();
@@ -100,20 +120,192 @@ namespace Log
 		void log(LogMessage msg);
 		void addListener(std::shared_ptr<LogListener> listener);
 		void removeListener(std::shared_ptr<LogListener> listener);
-#ifdef BUFFERED_LOGGING
-		void consumeLog();
-#endif
+
+		//messages are written as binary records (format string and raw arguments) into a ring buffer owned
+		//by the calling thread and formatted later by the writer thread.
+		//beginRecord() returns the location of the arguments or nullptr if the message must be logged directly.
+		u8* beginRecord(LogType type, LogSeverity sev, LogFormatFunc format, const char* fmt, size_t args_size);
+		void endRecord(LogSeverity sev);
+
+		//wait until all messages logged before this call are written
+		void flush();
+
+		//give the ring buffer of the calling thread back (called on thread exit)
+		void releaseThreadRing();
+
+		void stopWriter();
+
+		bool isExiting() const
+		{
+			return mExiting;
+		}
+
 	private:
-#ifdef BUFFERED_LOGGING
-		MTRingbuffer<char, MAX_LOG_BUFFER_LENGTH> mBuffer;
-		std::condition_variable mBufferReady;
-		std::mutex mStatusMut;
-		std::atomic<bool> mExiting;
-		std::thread mLogConsumer;
-#endif
+		void writerTask();
+		bool writeRecords();
+		void dispatch(LogMessage msg, const std::string& thread_name);
+		LogRing* acquireRing();
+		void wakeWriter();
+
 		std::array<LogChannel, std::tuple_size<decltype(gTypeNameTable)>::value> mChannels;
 		//std::array<LogChannel,gTypeNameTable.size()> mChannels; //TODO: use this once Microsoft sorts their shit out
+
+		std::mutex mRingsLock;
+		std::vector<LogRing*> mRings;
+		std::atomic<u64> mSequence;
+
+		std::thread mWriter;
+		std::mutex mWriterMutex;
+		std::condition_variable mWriterCond;
+		std::condition_variable mFlushCond;
+		bool mWakeWriter;
+		u64 mBatches; // count of writer passes, used by flush()
+		std::atomic<bool> mExiting;
+	};
+
+	//raw storage of log arguments (the types produced by fmt::do_unveil())
+	template<typename T>
+	struct LogArg
+	{
+		static size_t size(const T& arg)
+		{
+			return sizeof(T);
+		}
+
+		static void write(u8*& ptr, const T& arg)
+		{
+			memcpy(ptr, &arg, sizeof(T));
+			ptr += sizeof(T);
+		}
+
+		static T read(const u8*& ptr)
+		{
+			T arg;
+			memcpy(&arg, ptr, sizeof(T));
+			ptr += sizeof(T);
+			return arg;
+		}
+	};
+
+	//strings are copied into the record
+	template<>
+	struct LogArg<const char*>
+	{
+		static size_t size(const char* arg)
+		{
+			return (arg ? strlen(arg) : 0) + 1;
+		}
+
+		static void write(u8*& ptr, const char* arg)
+		{
+			const size_t size = LogArg::size(arg);
+			memcpy(ptr, arg ? arg : "", size);
+			ptr += size;
+		}
+
+		static const char* read(const u8*& ptr)
+		{
+			const char* arg = reinterpret_cast<const char*>(ptr);
+			ptr += strlen(arg) + 1;
+			return arg;
+		}
+	};
+
+	template<typename... Targs>
+	struct LogFormatter;
+
+	template<>
+	struct LogFormatter<>
+	{
+		template<typename... Tvals>
+		static std::string format(const char* fmt, const u8* args, Tvals... vals)
+		{
+			return fmt::detail::format(fmt, strlen(fmt), vals...);
+		}
+	};
+
+	template<typename T, typename... Targs>
+	struct LogFormatter<T, Targs...>
+	{
+		template<typename... Tvals>
+		static std::string format(const char* fmt, const u8* args, Tvals... vals)
+		{
+			const T arg = LogArg<T>::read(args);
+			return LogFormatter<Targs...>::format(fmt, args, vals..., arg);
+		}
+	};
+
+	//the arguments start with two strings (name and tag) which are prepended to the message
+	template<typename... Targs>
+	struct LogPrefixedFormatter
+	{
+		static std::string format(const char* fmt, const u8* args)
+		{
+			std::string result = LogArg<const char*>::read(args);
+			result += LogArg<const char*>::read(args);
+			return result + LogFormatter<Targs...>::template format<>(fmt, args);
+		}
 	};
+
+	inline size_t log_args_size()
+	{
+		return 0;
+	}
+
+	template<typename T, typename... Targs>
+	size_t log_args_size(const T& arg, const Targs&... args)
+	{
+		return LogArg<T>::size(arg) + log_args_size(args...);
+	}
+
+	inline void log_args_write(u8*& ptr)
+	{
+	}
+
+	template<typename T, typename... Targs>
+	void log_args_write(u8*& ptr, const T& arg, const Targs&... args)
+	{
+		LogArg<T>::write(ptr, arg);
+		log_args_write(ptr, args...);
+	}
+
+	inline bool check_log(LogType type, LogSeverity sev)
+	{
+		return LogManager::getInstance().getChannel(type).isEnabled(sev);
+	}
+
+	template<typename... Targs>
+	void log_record(LogType type, LogSeverity sev, const char* fmt, Targs... args)
+	{
+		LogManager& manager = LogManager::getInstance();
+
+		if (u8* ptr = manager.beginRecord(type, sev, &LogFormatter<Targs...>::template format<>, fmt, log_args_size(args...)))
+		{
+			log_args_write(ptr, args...);
+			manager.endRecord(sev);
+		}
+		else
+		{
+			manager.log({ type, sev, fmt::detail::format(fmt, strlen(fmt), args...) });
+		}
+	}
+
+	//same as log_record, the message is prefixed with name and tag (used by HLE modules)
+	template<typename... Targs>
+	void log_record_prefixed(LogType type, LogSeverity sev, const char* name, const char* tag, const char* fmt, Targs... args)
+	{
+		LogManager& manager = LogManager::getInstance();
+
+		if (u8* ptr = manager.beginRecord(type, sev, &LogPrefixedFormatter<Targs...>::format, fmt, log_args_size(name, tag, args...)))
+		{
+			log_args_write(ptr, name, tag, args...);
+			manager.endRecord(sev);
+		}
+		else
+		{
+			manager.log({ type, sev, std::string(name) + tag + fmt::detail::format(fmt, strlen(fmt), args...) });
+		}
+	}
 }
 
 static struct { inline operator Log::LogType() { return Log::LogType::GENERAL; } } GENERAL;
@@ -132,5 +324,8 @@ void log_message(Log::LogType type, Log::LogSeverity sev, std::string text);
 template<typename... Targs> 
 __noinline void log_message(Log::LogType type, Log::LogSeverity sev, const char* fmt, Targs... args)
 {
-	log_message(type, sev, fmt::detail::format(fmt, strlen(fmt), fmt::do_unveil(args)...));
+	if (Log::check_log(type, sev))
+	{
+		Log::log_record(type, sev, fmt, fmt::do_unveil(args)...);
+	}
 }
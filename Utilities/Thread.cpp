@@ -381,11 +381,17 @@ void NamedThreadBase::SetThreadName(const std::string& name)
 void NamedThreadBase::WaitForAnySignal(u64 time) // wait for Notify() signal or sleep
 {
 	std::unique_lock<std::mutex> lock(m_signal_mtx);
-	m_signal_cv.wait_for(lock, std::chrono::milliseconds(time));
+
+	// the signal isn't lost if Notify() was called before this function
+	m_signal_cv.wait_for(lock, std::chrono::milliseconds(time), [this](){ return m_signaled; });
+	m_signaled = false;
 }
 
-void NamedThreadBase::Notify() // wake up waiting thread or nothing
+void NamedThreadBase::Notify() // wake up waiting thread or make its next wait return immediately
 {
+	std::lock_guard<std::mutex> lock(m_signal_mtx);
+
+	m_signaled = true;
 	m_signal_cv.notify_one();
 }
 
@@ -442,6 +448,7 @@ void ThreadBase::Start()
 		}
 
 		m_alive = false;
+		Log::LogManager::getInstance().releaseThreadRing();
 		SetCurrentNamedThread(nullptr);
 		g_thread_count--;
 
@@ -595,6 +602,7 @@ void thread_t::start(std::function<void()> func)
 			LOG_NOTICE(HLE, name + " ended");
 		}
 
+		Log::LogManager::getInstance().releaseThreadRing();
 		SetCurrentNamedThread(nullptr);
 		g_thread_count--;
 
@@ -8,15 +8,16 @@ class NamedThreadBase
 	std::string m_name;
 	std::condition_variable m_signal_cv;
 	std::mutex m_signal_mtx;
+	bool m_signaled; // set by Notify(), consumed by WaitForAnySignal()
 
 public:
 	std::atomic<bool> m_tls_assigned;
 
-	NamedThreadBase(const std::string& name) : m_name(name), m_tls_assigned(false)
+	NamedThreadBase(const std::string& name) : m_name(name), m_signaled(false), m_tls_assigned(false)
 	{
 	}
 
-	NamedThreadBase() : m_tls_assigned(false)
+	NamedThreadBase() : m_signaled(false), m_tls_assigned(false)
 	{
 	}
 
@@ -8,6 +8,7 @@
 
 #ifdef _WIN32
 #include <Windows.h>
+#include <io.h>
 
 // Maybe in StrFmt?
 std::wstring ConvertUTF8ToWString(const std::string &source) {
@@ -22,6 +23,10 @@ std::wstring ConvertUTF8ToWString(const std::string &source) {
 }
 #endif
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #ifdef _WIN32
 #define GET_API_ERROR GetLastError()
 #else
@@ -307,6 +312,36 @@ size_t  rFile::Read(void *buffer, size_t count)
 	return reinterpret_cast<wxFile*>(handle)->Read(buffer,count);
 }
 
+size_t rFile::ReadAt(void *buffer, size_t count, u64 offset)
+{
+	const int fd = reinterpret_cast<wxFile*>(handle)->fd();
+#ifdef _WIN32
+	OVERLAPPED ov = {};
+	ov.Offset = (DWORD)offset;
+	ov.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD nread;
+	return ReadFile((HANDLE)_get_osfhandle(fd), buffer, (DWORD)count, &nread, &ov) ? nread : 0;
+#else
+	const ssize_t nread = pread(fd, buffer, count, offset);
+	return nread > 0 ? nread : 0;
+#endif
+}
+
+size_t rFile::WriteAt(const void *buffer, size_t count, u64 offset)
+{
+	const int fd = reinterpret_cast<wxFile*>(handle)->fd();
+#ifdef _WIN32
+	OVERLAPPED ov = {};
+	ov.Offset = (DWORD)offset;
+	ov.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD nwritten;
+	return WriteFile((HANDLE)_get_osfhandle(fd), buffer, (DWORD)count, &nwritten, &ov) ? nwritten : 0;
+#else
+	const ssize_t nwritten = pwrite(fd, buffer, count, offset);
+	return nwritten > 0 ? nwritten : 0;
+#endif
+}
+
 size_t 	rFile::Seek(size_t ofs, rSeekMode mode)
 {
 	return reinterpret_cast<wxFile*>(handle)->Seek(ofs, convertSeekMode(mode));
@@ -51,6 +51,9 @@ public:
 	bool 	IsOpened() const;
 	size_t	Length() const;
 	size_t  Read(void *buffer, size_t count);
+	// positional I/O, doesn't use the file position (except on Windows, where it's moved as well, so don't mix it with Read/Write/Seek)
+	size_t ReadAt(void *buffer, size_t count, u64 offset);
+	size_t WriteAt(const void *buffer, size_t count, u64 offset);
 	size_t 	Seek(size_t ofs, rSeekMode mode = rFromStart);
 	size_t Tell() const;
 
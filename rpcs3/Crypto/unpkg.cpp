@@ -71,85 +71,86 @@ bool LoadHeader(rFile& pkg_f, PKGHeader* m_header)
 	return true;
 }
 
-int Decrypt(rFile& pkg_f, rFile& dec_pkg_f, PKGHeader* m_header)
+// Every 16 byte block is encrypted with a key stream derived from its index (AES-CTR, or SHA1 of the counter for debug packages),
+// so any range of the data area can be decrypted independently of the others.
+struct PKGDecrypter
 {
-	if (!LoadHeader(pkg_f, m_header))
-		return -1;
-
-	aes_context c;
-	u8 iv[HASH_LEN];
-	u8 buf[BUF_SIZE];
-	u8 ctr[BUF_SIZE];
-	
-	// Debug key
-	u8 key[0x40];
-	memset(key, 0, 0x40);
-	memcpy(key+0x00, &m_header->qa_digest[0], 8); // &data[0x60]
-	memcpy(key+0x08, &m_header->qa_digest[0], 8); // &data[0x60]
-	memcpy(key+0x10, &m_header->qa_digest[8], 8); // &data[0x68]
-	memcpy(key+0x18, &m_header->qa_digest[8], 8); // &data[0x68]
+	PKGHeader header;
+	aes_context aes; // only read by aes_crypt_ecb, shared by all threads
+	u8 debug_key[0x40];
 
-	pkg_f.Seek(m_header->data_offset);
-	u32 parts = (m_header->data_size + BUF_SIZE - 1) / BUF_SIZE;
+	PKGDecrypter(const PKGHeader& header)
+		: header(header)
+	{
+		aes_setkey_enc(&aes, PKG_AES_KEY, 128);
 
-	wxProgressDialog pdlg("PKG Decrypter / Installer", "Please wait, decrypting...", parts, 0, wxPD_AUTO_HIDE | wxPD_APP_MODAL);
+		memset(debug_key, 0, 0x40);
+		memcpy(debug_key + 0x00, &header.qa_digest[0], 8); // &data[0x60]
+		memcpy(debug_key + 0x08, &header.qa_digest[0], 8); // &data[0x60]
+		memcpy(debug_key + 0x10, &header.qa_digest[8], 8); // &data[0x68]
+		memcpy(debug_key + 0x18, &header.qa_digest[8], 8); // &data[0x68]
+	}
 
-	memcpy(iv, m_header->klicensee, sizeof(iv));
-	aes_setkey_enc(&c, PKG_AES_KEY, 128);
-	
-	for (u32 i=0; i<parts; i++)
+	void GetKeyStream(u64 block, u8* out)
 	{
-		memset(buf, 0, sizeof(buf));
-		u32 length = pkg_f.Read(buf, BUF_SIZE);
-		u32 bits = (length + HASH_LEN - 1) / HASH_LEN;
-		
-		if (m_header->pkg_type == PKG_RELEASE_TYPE_DEBUG)
+		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
-			for (u32 j=0; j<bits; j++)
-			{
-				u8 hash[0x14];
-				sha1(key, 0x40, hash);
-				*(u64*)&buf[j*HASH_LEN + 0] ^= *(u64*)&hash[0];
-				*(u64*)&buf[j*HASH_LEN + 8] ^= *(u64*)&hash[8];
-				*(be_t<u64>*)&key[0x38] += 1;
-			}
+			u8 key[0x40];
+			u8 hash[0x14];
+			memcpy(key, debug_key, 0x40);
+			*(be_t<u64>*)&key[0x38] = block;
+			sha1(key, 0x40, hash);
+			memcpy(out, hash, HASH_LEN);
+		}
+		else
+		{
+			u8 iv[HASH_LEN];
+			const u64 hi = *(be_t<u64>*)&header.klicensee[0];
+			const u64 lo = *(be_t<u64>*)&header.klicensee[8];
+			*(be_t<u64>*)&iv[0] = hi + (lo + block < lo ? 1 : 0);
+			*(be_t<u64>*)&iv[8] = lo + block;
+			aes_crypt_ecb(&aes, AES_ENCRYPT, iv, out);
 		}
+	}
 
-		if (m_header->pkg_type == PKG_RELEASE_TYPE_RELEASE)
+	// read and decrypt size bytes at the offset in the data area (can be called from any thread)
+	bool Read(rFile& pkg_f, u64 offset, u8* buf, u64 size)
+	{
+		if (pkg_f.ReadAt(buf, size, header.data_offset + offset) != size)
 		{
-			for (u32 j=0; j<bits; j++)
-			{
-				aes_crypt_ecb(&c, AES_ENCRYPT, iv, ctr+j*HASH_LEN);
+			return false;
+		}
 
-				be_t<u64> hi = *(be_t<u64>*)&iv[0];
-				be_t<u64> lo = *(be_t<u64>*)&iv[8];
-				lo++;
+		u64 block = offset / HASH_LEN;
+		u32 skip = offset % HASH_LEN;
 
-				if (lo == 0)
-					hi += 1;
+		for (u64 pos = 0; pos < size; block++, skip = 0)
+		{
+			u8 ks[HASH_LEN];
+			GetKeyStream(block, ks);
 
-				*(be_t<u64>*)&iv[0] = hi;
-				*(be_t<u64>*)&iv[8] = lo;
-			}
-		
-			for (u32 j=0; j<length; j++) {
-				buf[j] ^= ctr[j];
+			for (u32 i = skip; i < HASH_LEN && pos < size; i++, pos++)
+			{
+				buf[pos] ^= ks[i];
 			}
-		}		
-		dec_pkg_f.Write(buf, length);
-		pdlg.Update(i);
+		}
+
+		return true;
 	}
-	pdlg.Update(parts);
-	return 0;
-}
+};
 
 // Unpacking.
-bool LoadEntries(rFile& dec_pkg_f, PKGHeader* m_header, PKGEntry *m_entries)
+bool LoadEntries(rFile& pkg_f, PKGDecrypter& dec, std::vector<PKGEntry>& m_entries)
 {
-	dec_pkg_f.Seek(0);
-	dec_pkg_f.Read(m_entries, sizeof(PKGEntry) * m_header->file_count);
+	m_entries.resize(dec.header.file_count);
+
+	if (m_entries.empty() || !dec.Read(pkg_f, 0, (u8*)m_entries.data(), sizeof(PKGEntry) * m_entries.size()))
+	{
+		LOG_ERROR(LOADER, "PKG: Could not read entries!");
+		return false;
+	}
 	
-	if (m_entries->name_offset / sizeof(PKGEntry) != m_header->file_count) {
+	if (m_entries[0].name_offset / sizeof(PKGEntry) != dec.header.file_count) {
 		LOG_ERROR(LOADER, "PKG: Entries are damaged!");
 		return false;
 	}
@@ -157,104 +158,195 @@ bool LoadEntries(rFile& dec_pkg_f, PKGHeader* m_header, PKGEntry *m_entries)
 	return true;
 }
 
-bool UnpackEntry(rFile& dec_pkg_f, const PKGEntry& entry, std::string dir)
+// file being written by the installer threads
+struct PKGFileJob
 {
-	char buf[BUF_SIZE];
+	std::string path;
+	u64 offset;
+	u64 size;
+	std::mutex mutex;
+	std::unique_ptr<rFile> out; // created by the first thread writing to it, closed after the last chunk
+	bool failed;
+	std::atomic<u32> chunks_left;
+};
+
+struct PKGChunk
+{
+	u32 file;
+	u64 pos;
+};
 
-	dec_pkg_f.Seek(entry.name_offset);
-	dec_pkg_f.Read(buf, entry.name_size);
-	buf[entry.name_size] = 0;
-	
-	switch (entry.type.data() >> 24)
+void UnpackChunk(rFile& pkg_f, PKGDecrypter& dec, PKGFileJob& file, u64 pos, std::vector<u8>& buf, bool& error)
+{
+	const u64 size = std::min<u64>(PKG_CHUNK_SIZE, file.size - pos);
+
+	if (!dec.Read(pkg_f, file.offset + pos, buf.data(), size))
 	{
-	case PKG_FILE_ENTRY_NPDRM:
-	case PKG_FILE_ENTRY_NPDRMEDAT:
-	case PKG_FILE_ENTRY_SDAT:
-	case PKG_FILE_ENTRY_REGULAR:
+		LOG_ERROR(LOADER, "PKG Loader: Could not read file data: %s", file.path.c_str());
+		error = true;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(file.mutex);
+
+	if (!file.out && !file.failed)
 	{
-		rFile out;
-		auto path = dir + std::string(buf, entry.name_size);
-		if (rExists(path))
-		{
-			LOG_WARNING(LOADER, "PKG Loader: File is overwritten: %s", path.c_str());
-		}
+		file.out.reset(new rFile());
 
-		if (out.Create(path, true /* overwriting */))
+		if (!file.out->Create(file.path, true /* overwriting */))
 		{
-			dec_pkg_f.Seek(entry.file_offset);
-
-			for (u64 size = 0; size < entry.file_size;) {
-				size += dec_pkg_f.Read(buf, BUF_SIZE);
-				if (size > entry.file_size)
-					out.Write(buf, BUF_SIZE - (size - entry.file_size));
-				else
-					out.Write(buf, BUF_SIZE);
-			}
-			out.Close();
-			return true;
-		}
-		else
-		{
-			LOG_ERROR(LOADER, "PKG Loader: Could not create file: %s", path.c_str());
-			return false;
+			LOG_ERROR(LOADER, "PKG Loader: Could not create file: %s", file.path.c_str());
+			file.out.reset();
+			file.failed = true;
 		}
 	}
 
-	case PKG_FILE_ENTRY_FOLDER:
+	if (file.out && file.out->WriteAt(buf.data(), size, pos) != size)
 	{
-		auto path = dir + std::string(buf, entry.name_size);
-		if (!rExists(path) && !rMkdir(path))
-		{
-			LOG_ERROR(LOADER, "PKG Loader: Could not create directory: %s", path.c_str());
-			return false;
-		}
-
-		return true;
+		LOG_ERROR(LOADER, "PKG Loader: Could not write file: %s", file.path.c_str());
+		file.failed = true;
 	}
 
-	default:
+	if (!--file.chunks_left)
 	{
-		LOG_ERROR(LOADER, "PKG Loader: unknown PKG file entry: 0x%x", entry.type);
-		return false;
-	}
+		file.out.reset();
 	}
 }
 
 int Unpack(rFile& pkg_f, std::string src, std::string dst)
 {
-	PKGHeader* m_header = (PKGHeader*) malloc (sizeof(PKGHeader));
-
-	rFile dec_pkg_f;
-	// TODO: This shouldn't use current dir
-	std::string decryptedFile = "./dev_hdd1/" + src + ".dec";
+	PKGHeader m_header;
 
-	dec_pkg_f.Create(decryptedFile, true);
-	
-	if (Decrypt(pkg_f, dec_pkg_f, m_header) < 0)
+	if (!LoadHeader(pkg_f, &m_header))
 		return -1;
-	
-	dec_pkg_f.Close();
 
-	rFile n_dec_pkg_f(decryptedFile, rFile::read);
+	PKGDecrypter dec(m_header);
 
 	std::vector<PKGEntry> m_entries;
-	m_entries.resize(m_header->file_count);
-
-	PKGEntry *m_entries_ptr = &m_entries[0];
-	if (!LoadEntries(n_dec_pkg_f, m_header, m_entries_ptr))
+	if (!LoadEntries(pkg_f, dec, m_entries))
 		return -1;
 
-	wxProgressDialog pdlg("PKG Decrypter / Installer", "Please wait, unpacking...", m_entries.size(), 0, wxPD_AUTO_HIDE | wxPD_APP_MODAL);
+	// create directories in order and collect the files, which are decrypted directly to their destination
+	const std::string dir = dst + src + "/";
+	std::vector<std::unique_ptr<PKGFileJob>> files;
+	std::vector<PKGChunk> chunks;
+	u64 total = 0;
 
 	for (const PKGEntry& entry : m_entries)
 	{
-		UnpackEntry(n_dec_pkg_f, entry, dst + src + "/");
-		pdlg.Update(pdlg.GetValue() + 1);
+		std::string name(entry.name_size, '\0');
+
+		if (!dec.Read(pkg_f, entry.name_offset, (u8*)&name[0], name.size()))
+		{
+			LOG_ERROR(LOADER, "PKG Loader: Could not read file name");
+			return -1;
+		}
+
+		const std::string path = dir + name;
+
+		switch (entry.type.data() >> 24)
+		{
+		case PKG_FILE_ENTRY_NPDRM:
+		case PKG_FILE_ENTRY_NPDRMEDAT:
+		case PKG_FILE_ENTRY_SDAT:
+		case PKG_FILE_ENTRY_REGULAR:
+		{
+			if (rExists(path))
+			{
+				LOG_WARNING(LOADER, "PKG Loader: File is overwritten: %s", path.c_str());
+			}
+
+			if (!entry.file_size)
+			{
+				rFile out;
+				if (!out.Create(path, true /* overwriting */))
+				{
+					LOG_ERROR(LOADER, "PKG Loader: Could not create file: %s", path.c_str());
+				}
+				break;
+			}
+
+			std::unique_ptr<PKGFileJob> file(new PKGFileJob());
+			file->path = path;
+			file->offset = entry.file_offset;
+			file->size = entry.file_size;
+			file->failed = false;
+			file->chunks_left = (u32)((file->size + PKG_CHUNK_SIZE - 1) / PKG_CHUNK_SIZE);
+
+			for (u64 pos = 0; pos < file->size; pos += PKG_CHUNK_SIZE)
+			{
+				chunks.push_back({ (u32)files.size(), pos });
+			}
+
+			total += file->size;
+			files.push_back(std::move(file));
+			break;
+		}
+
+		case PKG_FILE_ENTRY_FOLDER:
+		{
+			if (!rExists(path) && !rMkdir(path))
+			{
+				LOG_ERROR(LOADER, "PKG Loader: Could not create directory: %s", path.c_str());
+			}
+			break;
+		}
+
+		default:
+		{
+			LOG_ERROR(LOADER, "PKG Loader: unknown PKG file entry: 0x%x", entry.type);
+			break;
+		}
+		}
+	}
+
+	std::atomic<u32> next_chunk(0);
+	std::atomic<u64> progress(0);
+	std::atomic<u32> finished(0);
+	std::atomic<bool> error(false);
+
+	const u32 count = std::max<u32>(std::min<u32>(std::thread::hardware_concurrency(), (u32)chunks.size()), 1);
+	std::vector<std::thread> threads;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		threads.emplace_back([&]()
+		{
+			std::vector<u8> buf(PKG_CHUNK_SIZE);
+			bool thread_error = false;
+
+			for (u32 index; !thread_error && (index = next_chunk++) < chunks.size();)
+			{
+				PKGFileJob& file = *files[chunks[index].file];
+				UnpackChunk(pkg_f, dec, file, chunks[index].pos, buf, thread_error);
+				progress += std::min<u64>(PKG_CHUNK_SIZE, file.size - chunks[index].pos);
+			}
+
+			if (thread_error)
+			{
+				next_chunk = (u32)chunks.size(); // stop other threads
+				error = true;
+			}
+
+			finished++;
+		});
+	}
+
+	// the dialog is only updated by this thread, the workers just increase the counter
+	wxProgressDialog pdlg("PKG Decrypter / Installer", "Please wait, unpacking...", 1000, 0, wxPD_AUTO_HIDE | wxPD_APP_MODAL);
+
+	while (finished < count)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		pdlg.Update(total ? (int)(progress * 1000 / total) : 0);
+	}
+
+	for (auto& t : threads)
+	{
+		t.join();
 	}
-	pdlg.Update(m_entries.size());
 
-	n_dec_pkg_f.Close();
-	wxRemoveFile(decryptedFile);
+	pdlg.Update(1000);
 
-	return 0;
+	return error ? -1 : 0;
 }
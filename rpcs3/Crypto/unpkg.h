@@ -16,6 +16,7 @@
 
 #define HASH_LEN 16
 #define BUF_SIZE 4096
+#define PKG_CHUNK_SIZE 0x100000 // unit of work for the installer threads
 
 // Structs
 struct PKGHeader
@@ -47,4 +48,4 @@ struct PKGEntry
 
 class rFile;
 
-extern int Unpack(rFile& dec_pkg_f, std::string src, std::string dst);
\ No newline at end of file
+extern int Unpack(rFile& pkg_f, std::string src, std::string dst);
\ No newline at end of file
@@ -101,6 +101,7 @@ void ARMv7Thread::DoRun()
 
 	case 1:
 	case 2:
+	case 3:
 		m_dec = new ARMv7Decoder(context);
 	break;
 	}
@@ -6,6 +6,12 @@ class CPUDecoder
 public:
 	virtual u32 DecodeMemory(const u32 address) = 0;
 
+	// return true if DecodeMemory() stops on breakpoints itself
+	virtual bool HandlesBreakPoints() const
+	{
+		return false;
+	}
+
 	virtual ~CPUDecoder() = default;
 };
 
@@ -21,6 +27,24 @@ public:
 	{
 		return 0;
 	}
+
+	// predecoding: get the final caller for the code (skipping instruction lists)
+	virtual const InstrCaller<TO>* resolve(u32 code) const
+	{
+		return this;
+	}
+
+	// predecoding: extract arguments of resolved caller (up to 6)
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = code;
+	}
+
+	// predecoding: call resolved caller with extracted arguments
+	virtual void call(TO* op, const u32* args) const
+	{
+		(*this)(op, args[0]);
+	}
 };
 
 template<typename TO>
@@ -40,6 +64,15 @@ public:
 	{
 		(op->*m_func)();
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)();
+	}
 };
 
 template<typename TO, typename T1>
@@ -61,6 +94,16 @@ public:
 	{
 		(op->*m_func)((T1)m_arg_func_1(code));
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)((T1)args[0]);
+	}
 };
 
 template<typename TO, typename T1, typename T2>
@@ -87,6 +130,20 @@ public:
 			(T2)m_arg_func_2(code)
 		);
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+		args[1] = m_arg_func_2(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)(
+			(T1)args[0],
+			(T2)args[1]
+		);
+	}
 };
 
 template<typename TO, typename T1, typename T2, typename T3>
@@ -119,6 +176,22 @@ public:
 			(T3)m_arg_func_3(code)
 		);
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+		args[1] = m_arg_func_2(code);
+		args[2] = m_arg_func_3(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)(
+			(T1)args[0],
+			(T2)args[1],
+			(T3)args[2]
+		);
+	}
 };
 
 template<typename TO, typename T1, typename T2, typename T3, typename T4>
@@ -155,6 +228,24 @@ public:
 			(T4)m_arg_func_4(code)
 		);
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+		args[1] = m_arg_func_2(code);
+		args[2] = m_arg_func_3(code);
+		args[3] = m_arg_func_4(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)(
+			(T1)args[0],
+			(T2)args[1],
+			(T3)args[2],
+			(T4)args[3]
+		);
+	}
 };
 
 template<typename TO, typename T1, typename T2, typename T3, typename T4, typename T5>
@@ -195,6 +286,26 @@ public:
 			(T5)m_arg_func_5(code)
 		);
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+		args[1] = m_arg_func_2(code);
+		args[2] = m_arg_func_3(code);
+		args[3] = m_arg_func_4(code);
+		args[4] = m_arg_func_5(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)(
+			(T1)args[0],
+			(T2)args[1],
+			(T3)args[2],
+			(T4)args[3],
+			(T5)args[4]
+		);
+	}
 };
 
 template<typename TO, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
@@ -239,6 +350,28 @@ public:
 			(T6)m_arg_func_6(code)
 		);
 	}
+
+	virtual void extract(u32 code, u32* args) const
+	{
+		args[0] = m_arg_func_1(code);
+		args[1] = m_arg_func_2(code);
+		args[2] = m_arg_func_3(code);
+		args[3] = m_arg_func_4(code);
+		args[4] = m_arg_func_5(code);
+		args[5] = m_arg_func_6(code);
+	}
+
+	virtual void call(TO* op, const u32* args) const
+	{
+		(op->*m_func)(
+			(T1)args[0],
+			(T2)args[1],
+			(T3)args[2],
+			(T4)args[3],
+			(T5)args[4],
+			(T6)args[5]
+		);
+	}
 };
 
 template<typename TO>
@@ -529,6 +662,12 @@ public:
 		decode(op, m_func(code) & (count - 1), code);
 	}
 
+	virtual const InstrCaller<TO>* resolve(u32 code) const
+	{
+		const InstrCaller<TO>* func = m_instrs[m_func(code) & (count - 1)];
+		return func ? func->resolve(code) : nullptr;
+	}
+
 	virtual u32 operator [](u32 entry) const
 	{
 		return encode(entry);
@@ -325,7 +325,10 @@ void CPUThread::Task()
 
 	const std::vector<u64>& bp = Emu.GetBreakPoints();
 
-	for (uint i = 0; i<bp.size(); ++i)
+	// some decoders check breakpoints themselves
+	const bool check_bp = !m_dec->HandlesBreakPoints();
+
+	for (uint i = 0; check_bp && i<bp.size(); ++i)
 	{
 		if (bp[i] == m_offset + PC)
 		{
@@ -349,7 +352,7 @@ void CPUThread::Task()
 
 			if (status == CPUThread_Sleeping)
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+				PPUSchedulerSleep(1); // hack
 				continue;
 			}
 
@@ -363,7 +366,7 @@ void CPUThread::Task()
 				break;
 			}
 
-			for (uint i = 0; i < bp.size(); ++i)
+			for (uint i = 0; check_bp && i < bp.size(); ++i)
 			{
 				if (bp[i] == PC)
 				{
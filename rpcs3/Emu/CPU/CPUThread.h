@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/Thread.h"
+#include "CPUThreadManager.h"
 
 enum CPUThreadType :unsigned char
 {
@@ -257,7 +258,7 @@ public:
 		thread->SetJoinable(false);
 
 		while (thread->IsRunning())
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+			PPUSchedulerSleep(1); // hack
 
 		return thread->GetExitStatus();
 	}
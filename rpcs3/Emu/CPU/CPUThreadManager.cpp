@@ -1,4 +1,6 @@
 #include "stdafx.h"
+#include "rpcs3/Ini.h"
+#include "Utilities/Log.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/DbgCommand.h"
@@ -9,8 +11,26 @@
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/ARMv7/ARMv7Thread.h"
+#include "Emu/SysCalls/lv2/sys_time.h"
+
+// a ready thread waiting longer than this asks the lowest priority running thread to yield (in microseconds)
+const u64 PPU_SCHED_TIME_SLICE = 10000;
+
+// a ready thread waiting longer than this runs anyway (running threads may wait for it outside of lv2 primitives)
+const u64 PPU_SCHED_MAX_WAIT = 100000;
+
+namespace
+{
+	// lower value means higher priority, threads of equal priority are served in FIFO order
+	bool PPUSchedBefore(const PPUThread* a, const PPUThread* b)
+	{
+		return a->GetPrio() < b->GetPrio() || (a->GetPrio() == b->GetPrio() && a->sched_order < b->sched_order);
+	}
+}
 
 CPUThreadManager::CPUThreadManager()
+	: m_sched_budget(0)
+	, m_sched_order(0)
 {
 }
 
@@ -22,6 +42,11 @@ CPUThreadManager::~CPUThreadManager()
 void CPUThreadManager::Close()
 {
 	while(m_threads.size()) RemoveThread(m_threads[0]->GetId());
+
+	std::lock_guard<std::mutex> lock(m_sched_mutex);
+
+	// the setting is read again on next start
+	m_sched_budget = 0;
 }
 
 CPUThread& CPUThreadManager::AddThread(CPUThreadType type)
@@ -142,6 +167,27 @@ RawSPUThread* CPUThreadManager::GetRawSPUThread(u32 num)
 	}
 }
 
+bool CPUThreadManager::NotifyThread(u32 id)
+{
+	if (std::shared_ptr<CPUThread> t = GetThread(id))
+	{
+		t->Notify();
+		return true;
+	}
+
+	return false;
+}
+
+void CPUThreadManager::NotifyThreads()
+{
+	std::lock_guard<std::mutex> lock(m_mtx_thread);
+
+	for (auto& t : m_threads)
+	{
+		t->Notify();
+	}
+}
+
 void CPUThreadManager::Exec()
 {
 	std::lock_guard<std::mutex> lock(m_mtx_thread);
@@ -151,3 +197,170 @@ void CPUThreadManager::Exec()
 		m_threads[i]->Exec();
 	}
 }
+
+void CPUThreadManager::PPUGrantReady()
+{
+	while (m_sched_ready.size() && m_sched_running.size() < m_sched_budget)
+	{
+		auto best = std::min_element(m_sched_ready.begin(), m_sched_ready.end(), PPUSchedBefore);
+		PPUThread* thread = *best;
+
+		m_sched_ready.erase(best);
+		m_sched_running.push_back(thread);
+		thread->sched_running = true;
+		thread->Notify();
+	}
+}
+
+void CPUThreadManager::PPUWaitForSlot(std::unique_lock<std::mutex>& lock, PPUThread& thread)
+{
+	thread.sched_order = m_sched_order++;
+	m_sched_ready.push_back(&thread);
+	PPUGrantReady();
+
+	const u64 start_time = get_system_time();
+	bool preempted = false;
+
+	while (!thread.sched_running)
+	{
+		const u64 passed = get_system_time() - start_time;
+
+		if (Emu.IsStopped() || thread.TestDestroy() || passed >= PPU_SCHED_MAX_WAIT)
+		{
+			m_sched_ready.erase(std::find(m_sched_ready.begin(), m_sched_ready.end(), &thread));
+
+			if (passed >= PPU_SCHED_MAX_WAIT && !Emu.IsStopped() && !thread.TestDestroy())
+			{
+				// exceed the budget until some thread releases its slot
+				LOG_WARNING(PPU, "PPU scheduler: %s waited for %lld ms", thread.GetFName().c_str(), passed / 1000);
+				m_sched_running.push_back(&thread);
+				thread.sched_running = true;
+			}
+
+			return;
+		}
+
+		if (!preempted && passed >= PPU_SCHED_TIME_SLICE)
+		{
+			// ask the running thread with the lowest priority (not higher than own) to yield at the next instruction
+			PPUThread* victim = nullptr;
+
+			for (auto t : m_sched_running)
+			{
+				if (t->GetPrio() >= thread.GetPrio() && (!victim || PPUSchedBefore(victim, t)))
+				{
+					victim = t;
+				}
+			}
+
+			if (victim)
+			{
+				victim->sched_preempt = true;
+			}
+
+			preempted = true;
+		}
+
+		const u64 deadline = preempted ? PPU_SCHED_MAX_WAIT : PPU_SCHED_TIME_SLICE;
+
+		lock.unlock();
+		thread.WaitForAnySignal((deadline - passed + 999) / 1000);
+		lock.lock();
+	}
+}
+
+void CPUThreadManager::PPUAcquire(PPUThread& thread)
+{
+	std::unique_lock<std::mutex> lock(m_sched_mutex);
+
+	if (thread.sched_running)
+	{
+		return;
+	}
+
+	if (!m_sched_budget)
+	{
+		const u32 limit = Ini.PPUThreadLimit.GetValue();
+
+		m_sched_budget = limit ? limit : std::max<u32>(std::thread::hardware_concurrency(), 2);
+	}
+
+	if (m_sched_ready.empty() && m_sched_running.size() < m_sched_budget)
+	{
+		m_sched_running.push_back(&thread);
+		thread.sched_running = true;
+		return;
+	}
+
+	PPUWaitForSlot(lock, thread);
+}
+
+void CPUThreadManager::PPURelease(PPUThread& thread)
+{
+	std::lock_guard<std::mutex> lock(m_sched_mutex);
+
+	if (!thread.sched_running)
+	{
+		return;
+	}
+
+	m_sched_running.erase(std::find(m_sched_running.begin(), m_sched_running.end(), &thread));
+	thread.sched_running = false;
+	thread.sched_preempt = false;
+
+	PPUGrantReady();
+}
+
+void CPUThreadManager::PPUYield(PPUThread& thread)
+{
+	std::unique_lock<std::mutex> lock(m_sched_mutex);
+
+	thread.sched_preempt = false;
+
+	auto best = std::min_element(m_sched_ready.begin(), m_sched_ready.end(), PPUSchedBefore);
+
+	if (!thread.sched_running || best == m_sched_ready.end() || (*best)->GetPrio() > thread.GetPrio())
+	{
+		// nothing to hand over, only let the host run something else
+		lock.unlock();
+		std::this_thread::yield();
+		return;
+	}
+
+	// give the slot directly to the selected thread, even if the budget is exceeded
+	PPUThread* next = *best;
+	m_sched_ready.erase(best);
+	*std::find(m_sched_running.begin(), m_sched_running.end(), &thread) = next;
+	next->sched_running = true;
+	next->Notify();
+
+	thread.sched_running = false;
+	PPUWaitForSlot(lock, thread);
+}
+
+PPUSchedulerBlock::PPUSchedulerBlock()
+	: m_thread(nullptr)
+{
+	CPUThread* thread = GetCurrentCPUThread();
+
+	if (thread && thread->GetType() == CPU_THREAD_PPU && static_cast<PPUThread*>(thread)->sched_running)
+	{
+		m_thread = static_cast<PPUThread*>(thread);
+		Emu.GetCPU().PPURelease(*m_thread);
+	}
+}
+
+PPUSchedulerBlock::~PPUSchedulerBlock()
+{
+	if (m_thread)
+	{
+		Emu.GetCPU().PPUAcquire(*m_thread);
+	}
+}
+
+void PPUSchedulerSleep(u32 ms)
+{
+	PPUSchedulerBlock block;
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
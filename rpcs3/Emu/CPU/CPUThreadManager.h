@@ -2,6 +2,7 @@
 
 class CPUThread;
 class RawSPUThread;
+class PPUThread;
 enum CPUThreadType : unsigned char;
 
 class CPUThreadManager
@@ -9,6 +10,17 @@ class CPUThreadManager
 	std::vector<std::shared_ptr<CPUThread>> m_threads;
 	std::mutex m_mtx_thread;
 
+	// PPU scheduler: at most m_sched_budget PPU threads execute guest code at once,
+	// the others wait in m_sched_ready and get a slot in priority order
+	std::mutex m_sched_mutex;
+	std::vector<PPUThread*> m_sched_running;
+	std::vector<PPUThread*> m_sched_ready;
+	u32 m_sched_budget; // 0 if not initialized yet
+	u64 m_sched_order;
+
+	void PPUGrantReady();
+	void PPUWaitForSlot(std::unique_lock<std::mutex>& lock, PPUThread& thread);
+
 public:
 	CPUThreadManager();
 	~CPUThreadManager();
@@ -24,6 +36,29 @@ public:
 	std::shared_ptr<CPUThread> GetThread(u32 id, CPUThreadType type);
 	RawSPUThread* GetRawSPUThread(u32 num);
 
+	bool NotifyThread(u32 id);
+	void NotifyThreads();
+
 	void Exec();
 	void Task();
+
+	// get a slot before running guest code (blocks while the budget is exhausted)
+	void PPUAcquire(PPUThread& thread);
+	// give the slot to the next ready thread
+	void PPURelease(PPUThread& thread);
+	// hand the slot over to a ready thread of the same or higher priority, returns immediately if there is none
+	void PPUYield(PPUThread& thread);
+};
+
+// releases the slot of the current PPU thread while it's blocked in a syscall
+class PPUSchedulerBlock
+{
+	PPUThread* m_thread;
+
+public:
+	PPUSchedulerBlock();
+	~PPUSchedulerBlock();
 };
+
+// sleep used by HLE wait loops (the slot of the current PPU thread is released meanwhile)
+void PPUSchedulerSleep(u32 ms);
@@ -1,2 +1,202 @@
 #include "stdafx.h"
+#include "Emu/System.h"
 #include "MFC.h"
+
+DMAC::DMAC(exec_func_t exec, status_func_t status)
+	: m_exec(exec)
+	, m_status(status)
+	, m_queue_pos(0)
+	, m_queue_count(0)
+	, m_pending_mask(0)
+	, m_update(false)
+	, m_update_mask(0)
+	, m_update_type(0)
+	, m_stop(false)
+	, m_thread("DMAC Thread")
+{
+	memset(m_pending, 0, sizeof(m_pending));
+}
+
+DMAC::~DMAC()
+{
+	Stop();
+}
+
+bool DMAC::TestUpdate(u32 mask, u32 type) const
+{
+	switch (type)
+	{
+	case MFC_TAG_UPDATE_ANY: return !mask || (mask & ~m_pending_mask) != 0;
+	case MFC_TAG_UPDATE_ALL: return (mask & m_pending_mask) == 0;
+	}
+
+	return true;
+}
+
+void DMAC::Task()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (!m_queue_count)
+		{
+			m_cv_exec.wait(lock);
+			continue;
+		}
+
+		// the command stays in the queue while it's executed, so new commands are queued after it
+		const DMACCommand cmd = m_queue[m_queue_pos];
+
+		lock.unlock();
+		m_exec(cmd);
+		lock.lock();
+
+		if (m_stop)
+		{
+			break;
+		}
+
+		m_queue_pos = (m_queue_pos + 1) % queue_size;
+		m_queue_count--;
+
+		const u32 tag = cmd.tag & 31;
+
+		if (!--m_pending[tag])
+		{
+			m_pending_mask &= ~(1 << tag);
+
+			if (m_update && TestUpdate(m_update_mask, m_update_type))
+			{
+				m_update = false;
+				m_status(m_update_mask & ~m_pending_mask);
+			}
+		}
+
+		m_cv_done.notify_all();
+	}
+}
+
+bool DMAC::Enqueue(const DMACCommand& cmd)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (!m_queue_count && cmd.size < async_min_size)
+	{
+		// nothing to wait for, and faster than waking the thread
+		lock.unlock();
+		m_exec(cmd);
+		return true;
+	}
+
+	while (m_queue_count == queue_size)
+	{
+		if (Emu.IsStopped())
+		{
+			return false;
+		}
+
+		m_cv_done.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	if (!m_thread.joinable())
+	{
+		m_thread.start([this](){ Task(); });
+	}
+
+	const u32 tag = cmd.tag & 31;
+
+	m_queue[(m_queue_pos + m_queue_count++) % queue_size] = cmd;
+	m_pending[tag]++;
+	m_pending_mask |= 1 << tag;
+
+	m_cv_exec.notify_one();
+	return true;
+}
+
+void DMAC::Drain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_queue_count && !Emu.IsStopped())
+	{
+		m_cv_done.wait_for(lock, std::chrono::milliseconds(1));
+	}
+}
+
+void DMAC::RequestTagUpdate(u32 mask, u32 type)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// a new request replaces the previous one
+	m_update = false;
+
+	if (type == MFC_TAG_UPDATE_IMMEDIATE || TestUpdate(mask, type))
+	{
+		m_status(mask & ~m_pending_mask);
+		return;
+	}
+
+	m_update = true;
+	m_update_mask = mask;
+	m_update_type = type;
+}
+
+void DMAC::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_cv_exec.notify_one();
+	}
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_queue_pos = 0;
+	m_queue_count = 0;
+	memset(m_pending, 0, sizeof(m_pending));
+	m_pending_mask = 0;
+	m_update = false;
+	m_stop = false;
+}
+
+void DMAC::Copy(void* dst, const void* src, u32 size)
+{
+	if (size < stream_min_size)
+	{
+		memcpy(dst, src, size);
+		return;
+	}
+
+	u8* d = (u8*)dst;
+	const u8* s = (const u8*)src;
+
+	// align the destination for streaming stores
+	const u32 head = (0 - (u32)(size_t)d) & 15;
+	memcpy(d, s, head);
+	d += head;
+	s += head;
+	size -= head;
+
+	for (; size >= 64; size -= 64, d += 64, s += 64)
+	{
+		const __m128i v0 = _mm_loadu_si128((const __m128i*)s + 0);
+		const __m128i v1 = _mm_loadu_si128((const __m128i*)s + 1);
+		const __m128i v2 = _mm_loadu_si128((const __m128i*)s + 2);
+		const __m128i v3 = _mm_loadu_si128((const __m128i*)s + 3);
+		_mm_stream_si128((__m128i*)d + 0, v0);
+		_mm_stream_si128((__m128i*)d + 1, v1);
+		_mm_stream_si128((__m128i*)d + 2, v2);
+		_mm_stream_si128((__m128i*)d + 3, v3);
+	}
+
+	memcpy(d, s, size);
+
+	// make streaming stores visible before the completion is reported
+	_mm_sfence();
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "Utilities/Thread.h"
 
 enum
 {
@@ -59,6 +60,75 @@ enum
 	MFC_SPU_MAX_QUEUE_SPACE                 = 0x10,
 };
 
-struct DMAC
+// MFC_WrTagUpdate values
+enum
+{
+	MFC_TAG_UPDATE_IMMEDIATE = 0,
+	MFC_TAG_UPDATE_ANY       = 1,
+	MFC_TAG_UPDATE_ALL       = 2,
+};
+
+struct DMACCommand
+{
+	u32 cmd;
+	u32 tag;
+	u32 lsa;
+	u64 ea;
+	u32 size;
+};
+
+// MFC command queue of an SPU thread
+// Commands are executed in order, which satisfies fence and barrier flags. Transfers are executed by a separate
+// thread if they are large or something is already queued, tag status updates are sent when the tags complete.
+class DMAC
 {
+public:
+	typedef std::function<void(const DMACCommand& cmd)> exec_func_t;
+	typedef std::function<void(u32 tag_status)> status_func_t;
+
+	static const u32 queue_size = MFC_SPU_MAX_QUEUE_SPACE;
+	static const u32 async_min_size = 0x4000; // smaller transfers are executed directly if the queue is empty
+	static const u32 stream_min_size = 0x4000; // larger copies bypass the cache (see Copy())
+
+private:
+	const exec_func_t m_exec;
+	const status_func_t m_status;
+
+	DMACCommand m_queue[queue_size]; // ring, the first command is being executed
+	u32 m_queue_pos;
+	u32 m_queue_count;
+	u32 m_pending[32]; // queued commands of each tag
+	u32 m_pending_mask;
+
+	bool m_update; // tag status update waiting for completion
+	u32 m_update_mask;
+	u32 m_update_type;
+
+	bool m_stop;
+	std::mutex m_mutex;
+	std::condition_variable m_cv_exec; // command queued or stopping
+	std::condition_variable m_cv_done; // command completed
+	thread_t m_thread;
+
+	bool TestUpdate(u32 mask, u32 type) const;
+	void Task();
+
+public:
+	DMAC(exec_func_t exec, status_func_t status);
+	~DMAC();
+
+	// returns false if the emulator was stopped while the queue was full
+	bool Enqueue(const DMACCommand& cmd);
+
+	// wait until all queued commands are complete
+	void Drain();
+
+	// MFC_WrTagUpdate
+	void RequestTagUpdate(u32 mask, u32 type);
+
+	// discard queued commands and stop the thread
+	void Stop();
+
+	// memcpy() using non-temporal stores for large sizes
+	static void Copy(void* dst, const void* src, u32 size);
 };
@@ -0,0 +1,207 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "PPUInstrTable.h"
+#include "PPUCachedDecoder.h"
+
+namespace PPUPredecodedCache
+{
+	typedef std::array<PPUPredecoded, 4096 / sizeof(u32)> page_t;
+
+	// 1 MB regions -> 4 KB pages
+	std::atomic<std::atomic<page_t*>*> g_regions[0x1000];
+
+	std::mutex g_mutex; // protects allocation
+	u32 g_decoders = 0; // count of existing decoders
+
+	PPUPredecoded* GetEntry(u32 addr)
+	{
+		const auto region = g_regions[addr >> 20].load(std::memory_order_acquire);
+
+		if (!region)
+		{
+			return nullptr;
+		}
+
+		const auto page = region[(addr >> 12) & 0xff].load(std::memory_order_acquire);
+
+		return page ? &(*page)[(addr & 0xfff) / sizeof(u32)] : nullptr;
+	}
+
+	PPUPredecoded& AllocEntry(u32 addr)
+	{
+		if (auto entry = GetEntry(addr))
+		{
+			return *entry;
+		}
+
+		std::lock_guard<std::mutex> lock(g_mutex);
+
+		auto region = g_regions[addr >> 20].load(std::memory_order_relaxed);
+
+		if (!region)
+		{
+			region = new std::atomic<page_t*>[0x100];
+
+			for (u32 i = 0; i < 0x100; i++)
+			{
+				region[i].store(nullptr, std::memory_order_relaxed);
+			}
+
+			g_regions[addr >> 20].store(region, std::memory_order_release);
+		}
+
+		auto page = region[(addr >> 12) & 0xff].load(std::memory_order_relaxed);
+
+		if (!page)
+		{
+			page = new page_t();
+			memset(page->data(), 0, sizeof(page_t));
+			region[(addr >> 12) & 0xff].store(page, std::memory_order_release);
+		}
+
+		return (*page)[(addr & 0xfff) / sizeof(u32)];
+	}
+
+	void Invalidate(u32 addr)
+	{
+		if (auto entry = GetEntry(addr))
+		{
+			u32 seq = entry->seq.load(std::memory_order_relaxed);
+
+			// wait for the writer, if any (it only fills the entry)
+			while ((seq & 1) || !entry->seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+			{
+				_mm_pause();
+				seq = entry->seq.load(std::memory_order_relaxed);
+			}
+
+			entry->func = nullptr;
+			entry->seq.store(seq + 2, std::memory_order_release);
+		}
+	}
+
+	void Clear()
+	{
+		// must be called when no decoder exists
+		for (auto& r : g_regions)
+		{
+			if (const auto region = r.exchange(nullptr))
+			{
+				for (u32 i = 0; i < 0x100; i++)
+				{
+					delete region[i].load();
+				}
+
+				delete[] region;
+			}
+		}
+	}
+}
+
+PPUCachedDecoder::PPUCachedDecoder(PPUOpcodes* op)
+	: m_op(op)
+	, m_bp_skip(0)
+{
+	std::lock_guard<std::mutex> lock(PPUPredecodedCache::g_mutex);
+	PPUPredecodedCache::g_decoders++;
+}
+
+PPUCachedDecoder::~PPUCachedDecoder()
+{
+	delete m_op;
+
+	std::lock_guard<std::mutex> lock(PPUPredecodedCache::g_mutex);
+
+	if (!--PPUPredecodedCache::g_decoders)
+	{
+		PPUPredecodedCache::Clear();
+	}
+}
+
+void PPUCachedDecoder::Decode(const u32 code)
+{
+	(*PPU_instr::main_list)(m_op, code);
+}
+
+u32 PPUCachedDecoder::DecodeMemory(const u32 address)
+{
+	// raw opcode is compared with the predecoded one, so any code modification is detected
+	const u32 code = vm::get_ref<u32>(address);
+
+	if (const auto entry = PPUPredecodedCache::GetEntry(address))
+	{
+		// seqlock: the copy is consistent if the sequence number was even and is unchanged after it
+		const u32 seq = entry->seq.load(std::memory_order_acquire);
+
+		if (!(seq & 1))
+		{
+			const auto func = entry->func;
+			const u32 entry_code = entry->code;
+			u32 args[6];
+			memcpy(args, entry->args, sizeof(args));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (func && entry_code == code && entry->seq.load(std::memory_order_relaxed) == seq)
+			{
+				func->call(m_op, args);
+				return sizeof(u32);
+			}
+		}
+	}
+
+	return DecodeSlow(address, code);
+}
+
+u32 PPUCachedDecoder::DecodeSlow(const u32 address, const u32 code)
+{
+	const u32 opcode = re32(code);
+
+	// breakpoint entries are never predecoded, so they always get here
+	const std::vector<u64>& bp = Emu.GetBreakPoints();
+
+	if (std::find(bp.begin(), bp.end(), address) != bp.end())
+	{
+		if (m_bp_skip != address)
+		{
+			// stop before executing the instruction
+			m_bp_skip = address;
+			Emu.Pause();
+			return 0;
+		}
+
+		m_bp_skip = 0;
+		Decode(opcode);
+		return sizeof(u32);
+	}
+
+	PPUPredecoded& entry = PPUPredecodedCache::AllocEntry(address);
+
+	const InstrCaller<PPUOpcodes>* func = PPU_instr::main_list->resolve(opcode);
+
+	if (!func)
+	{
+		// no handler (shouldn't happen), use table lookup
+		func = PPU_instr::main_list;
+	}
+
+	// the entry is only updated if no other thread is modifying it (otherwise the instruction is just executed)
+	u32 seq = entry.seq.load(std::memory_order_relaxed);
+
+	if (!(seq & 1) && entry.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+	{
+		// readers see the odd number or a changed one after reading the entry
+		std::atomic_thread_fence(std::memory_order_release);
+		entry.func = func;
+		entry.code = code;
+		func->extract(opcode, entry.args);
+		entry.seq.store(seq + 2, std::memory_order_release);
+	}
+
+	u32 args[6];
+	func->extract(opcode, args);
+	func->call(m_op, args);
+	return sizeof(u32);
+}
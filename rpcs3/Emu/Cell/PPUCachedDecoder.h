@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Emu/Cell/PPUOpcodes.h"
+#include "Emu/Cell/PPCDecoder.h"
+
+// predecoded PPU instruction
+struct PPUPredecoded
+{
+	std::atomic<u32> seq; // odd while the entry is being modified, increased by every modification (readers check it's unchanged)
+	const InstrCaller<PPUOpcodes>* func; // nullptr if the entry must be decoded again (or contains a breakpoint)
+	u32 code; // opcode as stored in memory, used to detect modified code
+	u32 args[6];
+};
+
+// predecoded guest code shared by all PPU threads (one table for each 4 KB page, allocated on first execution)
+namespace PPUPredecodedCache
+{
+	PPUPredecoded* GetEntry(u32 addr); // returns nullptr if the page isn't allocated
+	PPUPredecoded& AllocEntry(u32 addr);
+	void Invalidate(u32 addr); // force decoding the instruction again (used when breakpoints change)
+	void Clear();
+}
+
+// PPU interpreter executing predecoded instructions
+class PPUCachedDecoder : public PPCDecoder
+{
+	PPUOpcodes* m_op;
+	u32 m_bp_skip; // breakpoint address which will be executed after resuming
+
+	u32 DecodeSlow(const u32 address, const u32 code);
+
+public:
+	PPUCachedDecoder(PPUOpcodes* op);
+
+	virtual ~PPUCachedDecoder();
+
+	virtual void Decode(const u32 code);
+
+	virtual u32 DecodeMemory(const u32 address);
+
+	virtual bool HandlesBreakPoints() const
+	{
+		return true;
+	}
+};
@@ -7,6 +7,7 @@
 #include "Emu/SysCalls/Static.h"
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/Memory/vm_reservation.h"
 #include "Emu/SysCalls/lv2/sys_time.h"
 
 #include <stdint.h>
@@ -2531,8 +2532,10 @@ private:
 	void LWARX(u32 rd, u32 ra, u32 rb)
 	{
 		CPU.R_ADDR = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		CPU.R_VALUE = vm::get_ref<u32>(vm::cast(CPU.R_ADDR));
-		CPU.GPR[rd] = re32((u32)CPU.R_VALUE);
+		u32 value;
+		CPU.R_STAMP = vm::reservation_acquire(&value, vm::cast(CPU.R_ADDR), sizeof(u32));
+		CPU.R_VALUE = value;
+		CPU.GPR[rd] = re32(value);
 	}
 	void LDX(u32 rd, u32 ra, u32 rb)
 	{
@@ -2683,7 +2686,7 @@ private:
 	void LDARX(u32 rd, u32 ra, u32 rb)
 	{
 		CPU.R_ADDR = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		CPU.R_VALUE = vm::get_ref<u64>(vm::cast(CPU.R_ADDR));
+		CPU.R_STAMP = vm::reservation_acquire(&CPU.R_VALUE, vm::cast(CPU.R_ADDR), sizeof(u64));
 		CPU.GPR[rd] = re64(CPU.R_VALUE);
 	}
 	void DCBF(u32 ra, u32 rb)
@@ -2802,7 +2805,11 @@ private:
 
 		if (CPU.R_ADDR == addr)
 		{
-			CPU.SetCR_EQ(0, InterlockedCompareExchange(vm::get_ptr<volatile u32>(vm::cast(CPU.R_ADDR)), re32((u32)CPU.GPR[rs]), (u32)CPU.R_VALUE) == (u32)CPU.R_VALUE);
+			// the stamp fails the store if the 128 byte line was updated, the exchange if the word was stored normally
+			CPU.SetCR_EQ(0, vm::reservation_update(vm::cast(addr), CPU.R_STAMP, [&]()
+			{
+				return InterlockedCompareExchange(vm::get_ptr<volatile u32>(vm::cast(addr)), re32((u32)CPU.GPR[rs]), (u32)CPU.R_VALUE) == (u32)CPU.R_VALUE;
+			}));
 		}
 		else
 		{
@@ -2861,7 +2868,10 @@ private:
 
 		if (CPU.R_ADDR == addr)
 		{
-			CPU.SetCR_EQ(0, InterlockedCompareExchange(vm::get_ptr<volatile u64>(vm::cast(CPU.R_ADDR)), re64(CPU.GPR[rs]), CPU.R_VALUE) == CPU.R_VALUE);
+			CPU.SetCR_EQ(0, vm::reservation_update(vm::cast(addr), CPU.R_STAMP, [&]()
+			{
+				return InterlockedCompareExchange(vm::get_ptr<volatile u64>(vm::cast(addr)), re64(CPU.GPR[rs]), CPU.R_VALUE) == CPU.R_VALUE;
+			}));
 		}
 		else
 		{
@@ -2,6 +2,8 @@
 #include "Utilities/Log.h"
 #include "Emu/Cell/PPULLVMRecompiler.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Utilities/rFile.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -121,8 +123,7 @@ Executable Compiler::Compile(const std::string & name, const ControlFlowGraph &
 
         if (!inline_all && *instr_i != cfg.start_address) {
             // Use an already compiled implementation of this block if available
-            auto ordinal = m_recompilation_engine.GetOrdinal(*instr_i);
-            if (ordinal != 0xFFFFFFFF) {
+            if (m_recompilation_engine.GetExecutable(*instr_i)) {
                 auto exit_instr_i32 = m_ir_builder->CreatePHI(m_ir_builder->getInt32Ty(), 0);
                 exit_instr_list.push_back(exit_instr_i32);
 
@@ -246,16 +247,18 @@ Executable Compiler::Compile(const std::string & name, const ControlFlowGraph &
     m_stats.translation_time += std::chrono::duration_cast<std::chrono::nanoseconds>(translate_end - optimize_end);
 
 #ifdef _DEBUG
-    m_recompilation_engine.Log() << "\nDisassembly:\n";
+    // Written in one go, so it isn't interleaved with the output of other compiler threads
+    std::string disassembly = "\nDisassembly:\n";
     auto disassembler = LLVMCreateDisasm(sys::getProcessTriple().c_str(), nullptr, 0, nullptr, nullptr);
     for (size_t pc = 0; pc < mci.size();) {
         char str[1024];
 
         auto size = LLVMDisasmInstruction(disassembler, ((u8 *)mci.address()) + pc, mci.size() - pc, (uint64_t)(((u8 *)mci.address()) + pc), str, sizeof(str));
-        m_recompilation_engine.Log() << fmt::Format("0x%08X: ", (u64)(((u8 *)mci.address()) + pc)) << str << '\n';
+        disassembly += fmt::Format("0x%08X: ", (u64)(((u8 *)mci.address()) + pc)) + str + '\n';
         pc += size;
     }
 
+    m_recompilation_engine.Log() << disassembly;
     LLVMDisasmDispose(disassembler);
 #endif
 
@@ -5645,8 +5648,7 @@ Value * Compiler::Call(const char * name, Func function, Args... args) {
 }
 
 llvm::Value * Compiler::IndirectCall(u32 address, Value * context_i64, bool is_function) {
-    auto ordinal          = m_recompilation_engine.AllocateOrdinal(address, is_function);
-    auto location_i64     = m_ir_builder->getInt64(m_recompilation_engine.GetAddressOfExecutableLookup() + (ordinal * sizeof(u64)));
+    auto location_i64     = m_ir_builder->getInt64((u64)m_recompilation_engine.AllocateExecutable(address, is_function));
     auto location_i64_ptr = m_ir_builder->CreateIntToPtr(location_i64, m_ir_builder->getInt64Ty()->getPointerTo());
     auto executable_i64   = m_ir_builder->CreateLoad(location_i64_ptr);
     auto executable_ptr   = m_ir_builder->CreateIntToPtr(executable_i64, m_compiled_function_type->getPointerTo());
@@ -5670,58 +5672,60 @@ void Compiler::InitRotateMask() {
 std::mutex                           RecompilationEngine::s_mutex;
 std::shared_ptr<RecompilationEngine> RecompilationEngine::s_the_instance = nullptr;
 
+static_assert(sizeof(std::atomic<Executable>) == sizeof(Executable), "Generated code expects a plain table of pointers");
+
 RecompilationEngine::RecompilationEngine()
     : ThreadBase("PPU Recompilation Engine")
     , m_log(nullptr)
-    , m_next_ordinal(0)
-    , m_compiler(*this, ExecutionEngine::ExecuteFunction, ExecutionEngine::ExecuteTillReturn) {
-    m_compiler.RunAllTests();
+    , m_pending_execution_traces(nullptr)
+    , m_execution_traces(nullptr)
+    , m_num_executables(0)
+    , m_cache_loaded_blocks(0)
+    , m_first_block_time(0) {
+    for (auto & page : m_executable_lookup) {
+        page.store(nullptr, std::memory_order_relaxed);
+    }
 }
 
 RecompilationEngine::~RecompilationEngine() {
     Stop();
-}
 
-u32 RecompilationEngine::AllocateOrdinal(u32 address, bool is_function) {
-    std::lock_guard<std::mutex> lock(m_address_to_ordinal_lock);
-
-    auto i = m_address_to_ordinal.find(address);
-    if (i == m_address_to_ordinal.end()) {
-        assert(m_next_ordinal < (sizeof(m_executable_lookup) / sizeof(m_executable_lookup[0])));
-
-        m_executable_lookup[m_next_ordinal] = is_function ? ExecutionEngine::ExecuteFunction : ExecutionEngine::ExecuteTillReturn;
-        std::atomic_thread_fence(std::memory_order_release);
-        i = m_address_to_ordinal.insert(m_address_to_ordinal.end(), std::make_pair(address, m_next_ordinal++));
+    for (auto & page : m_executable_lookup) {
+        delete[] page.exchange(nullptr);
     }
 
-    return i->second;
+    for (auto block : m_cache_pending_blocks) {
+        delete block;
+    }
 }
 
-u32 RecompilationEngine::GetOrdinal(u32 address) const {
-    std::lock_guard<std::mutex> lock(m_address_to_ordinal_lock);
+std::atomic<Executable> * RecompilationEngine::AllocateExecutable(u32 address, bool is_function) {
+    std::lock_guard<std::mutex> lock(m_executable_lookup_lock);
 
-    auto i = m_address_to_ordinal.find(address);
-    if (i != m_address_to_ordinal.end()) {
-        return i->second;
-    } else {
-        return 0xFFFFFFFF;
+    auto page = m_executable_lookup[address >> 16].load(std::memory_order_relaxed);
+    if (!page) {
+        page = new std::atomic<Executable>[0x10000 / 4];
+        for (u32 i = 0; i < 0x10000 / 4; i++) {
+            page[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        m_executable_lookup[address >> 16].store(page, std::memory_order_release);
     }
-}
 
-const Executable RecompilationEngine::GetExecutable(u32 ordinal) const {
-    std::atomic_thread_fence(std::memory_order_acquire);
-    return m_executable_lookup[ordinal];
-}
+    auto executable = &page[(address & 0xffff) / 4];
+    if (!executable->load(std::memory_order_relaxed)) {
+        executable->store(is_function ? ExecutionEngine::ExecuteFunction : ExecutionEngine::ExecuteTillReturn, std::memory_order_release);
+        m_num_executables++;
+    }
 
-u64 RecompilationEngine::GetAddressOfExecutableLookup() const {
-    return (u64)m_executable_lookup;
+    return executable;
 }
 
 void RecompilationEngine::NotifyTrace(ExecutionTrace * execution_trace) {
-    {
-        std::lock_guard<std::mutex> lock(m_pending_execution_traces_lock);
-        m_pending_execution_traces.push_back(execution_trace);
-    }
+    auto head = m_pending_execution_traces.load(std::memory_order_relaxed);
+    do {
+        execution_trace->next_pending = head;
+    } while (!m_pending_execution_traces.compare_exchange_weak(head, execution_trace, std::memory_order_release, std::memory_order_relaxed));
 
     if (!IsAlive()) {
         Start();
@@ -5731,14 +5735,16 @@ void RecompilationEngine::NotifyTrace(ExecutionTrace * execution_trace) {
     // TODO: Increase the priority of the recompilation engine thread
 }
 
-raw_fd_ostream & RecompilationEngine::Log() {
+RecompilationEngine::LogWriter RecompilationEngine::Log() {
+    std::unique_lock<std::mutex> lock(m_log_lock);
+
     if (!m_log) {
         std::string error;
         m_log = new raw_fd_ostream("PPULLVMRecompiler.log", error, sys::fs::F_Text);
         m_log->SetUnbuffered();
     }
 
-    return *m_log;
+    return LogWriter(std::move(lock), *m_log);
 }
 
 void RecompilationEngine::Task() {
@@ -5746,21 +5752,31 @@ void RecompilationEngine::Task() {
     std::chrono::nanoseconds idling_time(0);
     std::chrono::nanoseconds recompiling_time(0);
 
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start   = std::chrono::high_resolution_clock::now();
+    m_start_time = start;
+    StartCompilerThreads();
+    LoadBlockCache();
+
     while (!TestDestroy() && !Emu.IsStopped()) {
         bool             work_done_this_iteration = false;
         ExecutionTrace * execution_trace          = nullptr;
 
-        {
-            std::lock_guard<std::mutex> lock(m_pending_execution_traces_lock);
-
-            auto i = m_pending_execution_traces.begin();
-            if (i != m_pending_execution_traces.end()) {
-                execution_trace = *i;
-                m_pending_execution_traces.erase(i);
+        if (!m_execution_traces) {
+            // Take all pushed traces and restore their order
+            auto trace = m_pending_execution_traces.exchange(nullptr, std::memory_order_acquire);
+            while (trace) {
+                auto next           = trace->next_pending;
+                trace->next_pending = m_execution_traces;
+                m_execution_traces  = trace;
+                trace               = next;
             }
         }
 
+        if (m_execution_traces) {
+            execution_trace    = m_execution_traces;
+            m_execution_traces = execution_trace->next_pending;
+        }
+
         if (execution_trace) {
             ProcessExecutionTrace(*execution_trace);
             delete execution_trace;
@@ -5773,6 +5789,10 @@ void RecompilationEngine::Task() {
             is_idling = false;
         }
 
+        if (is_idling && ProcessPendingCacheBlocks()) {
+            work_done_this_iteration = true;
+        }
+
         if (is_idling) {
             auto recompiling_start = std::chrono::high_resolution_clock::now();
 
@@ -5810,19 +5830,37 @@ void RecompilationEngine::Task() {
         }
     }
 
+    StopCompilerThreads();
+
+    Compiler::Stats compiler_stats = {};
+    for (auto & thread : m_compiler_threads) {
+        auto stats                        = thread->compiler.GetStats();
+        compiler_stats.ir_build_time     += stats.ir_build_time;
+        compiler_stats.optimization_time += stats.optimization_time;
+        compiler_stats.translation_time  += stats.translation_time;
+        compiler_stats.total_time        += stats.total_time;
+    }
+
+    SaveBlockCache();
+
     std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
     auto total_time     = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-    auto compiler_stats = m_compiler.GetStats();
 
     Log() << "Total time                      = " << total_time.count() / 1000000 << "ms\n";
+    Log() << "    Compiler threads            = " << (u32)m_compiler_threads.size() << "\n";
     Log() << "    Time spent compiling        = " << compiler_stats.total_time.count() / 1000000 << "ms\n";
     Log() << "        Time spent building IR  = " << compiler_stats.ir_build_time.count() / 1000000 << "ms\n";
     Log() << "        Time spent optimizing   = " << compiler_stats.optimization_time.count() / 1000000 << "ms\n";
     Log() << "        Time spent translating  = " << compiler_stats.translation_time.count() / 1000000 << "ms\n";
     Log() << "    Time spent recompiling      = " << recompiling_time.count() / 1000000 << "ms\n";
     Log() << "    Time spent idling           = " << idling_time.count() / 1000000 << "ms\n";
-    Log() << "    Time spent doing misc tasks = " << (total_time.count() - idling_time.count() - compiler_stats.total_time.count()) / 1000000 << "ms\n";
-    Log() << "Ordinals allocated              = " << m_next_ordinal << "\n";
+    Log() << "    Time spent doing misc tasks = " << (total_time.count() - idling_time.count() - recompiling_time.count()) / 1000000 << "ms\n";
+    Log() << "Executables allocated           = " << m_num_executables << "\n";
+    Log() << "Blocks loaded from cache        = " << m_cache_loaded_blocks << "\n";
+    Log() << "Time to first compiled block    = " << m_first_block_time.count() / 1000000 << "ms\n";
+
+    LOG_NOTICE(PPU, "PPU LLVM Recompiler: first block compiled after %lldms (%s start, %d blocks loaded from cache)",
+        m_first_block_time.count() / 1000000, m_cache_loaded_blocks ? "warm" : "cold", m_cache_loaded_blocks);
 
     LOG_NOTICE(PPU, "PPU LLVM Recompilation thread exiting.");
     s_the_instance = nullptr; // Can cause deadlock if this is the last instance. Need to fix this.
@@ -5920,12 +5958,306 @@ void RecompilationEngine::CompileBlock(BlockEntry & block_entry) {
     Log() << "CFG: " << block_entry.cfg.ToString() << "\n";
 #endif
 
-    auto ordinal    = AllocateOrdinal(block_entry.cfg.start_address, block_entry.IsFunction());
-    auto executable = m_compiler.Compile(fmt::Format("fn_0x%08X_%u", block_entry.cfg.start_address, block_entry.revision++), block_entry.cfg, true,
-                                         block_entry.IsFunction() ? true : false /*generate_linkable_exits*/);
-    m_executable_lookup[ordinal]       = executable;
+    auto task         = new CompileTask(block_entry);
+    task->executable  = AllocateExecutable(block_entry.cfg.start_address, block_entry.IsFunction());
+    task->priority    = block_entry.num_hits;
+    task->is_function = block_entry.IsFunction();
+
+    {
+        std::lock_guard<std::mutex> lock(m_compile_queue_lock);
+        task->revision = block_entry.revision++;
+        task->name     = fmt::Format("fn_0x%08X_%u", block_entry.cfg.start_address, task->revision);
+        m_compile_queue.push(task);
+    }
+
     block_entry.last_compiled_cfg_size = block_entry.cfg.GetSize();
     block_entry.is_compiled            = true;
+
+    if (!SerializeBlock(block_entry.cfg, block_entry.cache_record)) {
+        block_entry.cache_record.clear();
+    }
+
+    for (auto & thread : m_compiler_threads) {
+        thread->Notify();
+    }
+}
+
+bool RecompilationEngine::CompileNextBlock(Compiler & compiler) {
+    CompileTask * task;
+
+    {
+        std::lock_guard<std::mutex> lock(m_compile_queue_lock);
+
+        if (m_compile_queue.empty()) {
+            return false;
+        }
+
+        task = m_compile_queue.top();
+        m_compile_queue.pop();
+    }
+
+    auto executable = compiler.Compile(task->name, task->cfg, true, task->is_function /*generate_linkable_exits*/);
+
+    {
+        std::lock_guard<std::mutex> lock(m_compile_queue_lock);
+
+        // Don't overwrite a newer revision that finished first
+        if (task->revision + 1 == task->block->revision) {
+            task->executable->store(executable, std::memory_order_release);
+        }
+
+        if (m_first_block_time.count() == 0) {
+            m_first_block_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_start_time);
+        }
+    }
+
+    delete task;
+    return true;
+}
+
+void RecompilationEngine::StartCompilerThreads() {
+    if (m_compiler_threads.empty()) {
+        // Leave some cores to the emulated PPU/SPU threads and RSX
+        const u32 count = std::max<u32>(std::thread::hardware_concurrency() / 2, 1);
+
+        for (u32 i = 0; i < count; i++) {
+            m_compiler_threads.emplace_back(new CompilerThread(*this, i));
+        }
+
+        m_compiler_threads[0]->compiler.RunAllTests();
+    }
+
+    for (auto & thread : m_compiler_threads) {
+        thread->Start();
+    }
+}
+
+void RecompilationEngine::StopCompilerThreads() {
+    // The threads (and their compilers) are kept alive, the generated code may still be in use
+    for (auto & thread : m_compiler_threads) {
+        thread->Stop();
+    }
+
+    std::lock_guard<std::mutex> lock(m_compile_queue_lock);
+
+    while (!m_compile_queue.empty()) {
+        delete m_compile_queue.top();
+        m_compile_queue.pop();
+    }
+}
+
+CompilerThread::CompilerThread(RecompilationEngine & recompilation_engine, u32 id)
+    : ThreadBase(fmt::Format("PPU Compiler %u", id))
+    , compiler(recompilation_engine, ExecutionEngine::ExecuteFunction, ExecutionEngine::ExecuteTillReturn)
+    , m_recompilation_engine(recompilation_engine) {
+}
+
+CompilerThread::~CompilerThread() {
+    Stop();
+}
+
+void CompilerThread::Task() {
+    while (!TestDestroy() && !Emu.IsStopped()) {
+        if (!m_recompilation_engine.CompileNextBlock(compiler)) {
+            WaitForAnySignal(250);
+        }
+    }
+}
+
+/// Header of the block cache file. The version must be incremented whenever the record layout or the hash changes.
+static const u32 s_block_cache_magic   = 0x43424c50; // "PLBC"
+static const u32 s_block_cache_version = 1;
+
+std::string RecompilationEngine::GetBlockCachePath() {
+    const std::string title_id = Emu.GetTitleID();
+
+    return "./data/cache/" + (title_id.length() ? title_id : std::string("unknown")) + "/ppu_llvm/";
+}
+
+bool RecompilationEngine::SerializeBlock(const ControlFlowGraph & cfg, std::vector<u32> & record) {
+    // Layout: size, start address, function address, hash (2 words), instruction addresses, branches, calls.
+    // Sets are written as a count followed by the elements. The hash covers the CFG and the code of all instructions.
+    record.clear();
+    record.push_back(0);
+    record.push_back(cfg.start_address);
+    record.push_back(cfg.function_address);
+    record.push_back(0);
+    record.push_back(0);
+
+    record.push_back((u32)cfg.instruction_addresses.size());
+    record.insert(record.end(), cfg.instruction_addresses.begin(), cfg.instruction_addresses.end());
+
+    for (auto map : { &cfg.branches, &cfg.calls }) {
+        record.push_back((u32)map->size());
+        for (auto i = map->begin(); i != map->end(); i++) {
+            record.push_back(i->first);
+            record.push_back((u32)i->second.size());
+            record.insert(record.end(), i->second.begin(), i->second.end());
+        }
+    }
+
+    record[0] = (u32)record.size();
+
+    // FNV-1a
+    u64 hash = 0xcbf29ce484222325ull;
+    auto hash_u32 = [&hash](u32 value) {
+        for (u32 i = 0; i < 4; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    };
+
+    for (size_t i = 0; i < record.size(); i++) {
+        hash_u32(record[i]);
+    }
+
+    for (auto i = cfg.instruction_addresses.begin(); i != cfg.instruction_addresses.end(); i++) {
+        if (!Memory.IsGoodAddr(*i, 4)) {
+            return false;
+        }
+
+        hash_u32(vm::get_ref<u32>(*i));
+    }
+
+    record[3] = (u32)hash;
+    record[4] = (u32)(hash >> 32);
+    return true;
+}
+
+void RecompilationEngine::LoadBlockCache() {
+    const std::string path = GetBlockCachePath() + "blocks.bin";
+
+    if (!rExists(path)) {
+        return;
+    }
+
+    rFile f(path, rFile::read);
+    std::vector<u32> data(f.IsOpened() ? f.Length() / sizeof(u32) : 0);
+
+    if (data.empty() || f.Read(data.data(), data.size() * sizeof(u32)) != data.size() * sizeof(u32)) {
+        LOG_ERROR(PPU, "PPU LLVM Recompiler: failed to read '%s'", path.c_str());
+        return;
+    }
+
+    if (data.size() < 2 || data[0] != s_block_cache_magic || data[1] != s_block_cache_version) {
+        // Written by another version, it will be replaced on exit
+        LOG_WARNING(PPU, "PPU LLVM Recompiler: '%s' is outdated, ignored", path.c_str());
+        return;
+    }
+
+    // Rebuild the CFGs. The recorded hash is checked against the current code before compiling.
+    u32 rejected = 0;
+    for (size_t pos = 2; pos < data.size();) {
+        const u32 size = data[pos];
+        if (size < 8 || pos + size > data.size()) {
+            LOG_ERROR(PPU, "PPU LLVM Recompiler: '%s' is corrupted", path.c_str());
+            break;
+        }
+
+        const u32 * record = &data[pos];
+        const u32 * end    = record + size;
+        pos += size;
+
+        auto block = new BlockEntry(record[1], record[2]);
+        auto ptr   = record + 5;
+        bool valid = true;
+
+        auto read = [&ptr, end, &valid]() -> u32 {
+            if (ptr >= end) {
+                valid = false;
+                return 0;
+            }
+
+            return *ptr++;
+        };
+
+        for (u32 n = read(); valid && n; n--) {
+            block->cfg.instruction_addresses.insert(read());
+        }
+
+        for (auto map : { &block->cfg.branches, &block->cfg.calls }) {
+            for (u32 n = read(); valid && n; n--) {
+                auto & targets = (*map)[read()];
+                for (u32 k = read(); valid && k; k--) {
+                    targets.insert(read());
+                }
+            }
+        }
+
+        if (!valid || ptr != end || block->cfg.instruction_addresses.empty() || m_block_table.find(block) != m_block_table.end()) {
+            rejected++;
+            delete block;
+            continue;
+        }
+
+        block->cache_record.assign(record, end);
+        m_cache_pending_blocks.push_back(block);
+    }
+
+    ProcessPendingCacheBlocks();
+
+    LOG_NOTICE(PPU, "PPU LLVM Recompiler: %d blocks loaded from cache, %d pending, %d rejected",
+        m_cache_loaded_blocks, m_cache_pending_blocks.size(), rejected);
+}
+
+bool RecompilationEngine::ProcessPendingCacheBlocks() {
+    bool work_done = false;
+
+    for (auto i = m_cache_pending_blocks.begin(); i != m_cache_pending_blocks.end();) {
+        auto block = *i;
+
+        std::vector<u32> record;
+        if (!SerializeBlock(block->cfg, record)) {
+            // Code not loaded yet (PRX loaded later)
+            i++;
+            continue;
+        }
+
+        i         = m_cache_pending_blocks.erase(i);
+        work_done = true;
+
+        if (record != block->cache_record || m_block_table.find(block) != m_block_table.end()) {
+            // The code has changed or the block has already been found by tracing
+            delete block;
+            continue;
+        }
+
+        m_block_table.insert(block);
+        CompileBlock(*block);
+        m_cache_loaded_blocks++;
+    }
+
+    return work_done;
+}
+
+void RecompilationEngine::SaveBlockCache() {
+    const std::string dir = GetBlockCachePath();
+
+    if (!rExists(dir) && !rMkpath(dir)) {
+        LOG_ERROR(PPU, "PPU LLVM Recompiler: failed to create '%s'", dir.c_str());
+        return;
+    }
+
+    rFile f(dir + "blocks.bin", rFile::write);
+
+    if (!f.IsOpened()) {
+        LOG_ERROR(PPU, "PPU LLVM Recompiler: failed to write '%sblocks.bin'", dir.c_str());
+        return;
+    }
+
+    const u32 header[] = { s_block_cache_magic, s_block_cache_version };
+    f.Write(header, sizeof(header));
+
+    // Pending blocks are kept so that code loaded late isn't lost from the cache
+    for (auto block : m_cache_pending_blocks) {
+        f.Write(block->cache_record.data(), block->cache_record.size() * sizeof(u32));
+    }
+
+    for (auto block : m_block_table) {
+        if (block->is_compiled && block->cache_record.size()) {
+            f.Write(block->cache_record.data(), block->cache_record.size() * sizeof(u32));
+        }
+    }
 }
 
 std::shared_ptr<RecompilationEngine> RecompilationEngine::GetInstance() {
@@ -6022,7 +6354,6 @@ ppu_recompiler_llvm::ExecutionEngine::ExecutionEngine(PPUThread & ppu)
     : m_ppu(ppu)
     , m_interpreter(new PPUInterpreter(ppu))
     , m_decoder(m_interpreter)
-    , m_last_cache_clear_time(std::chrono::high_resolution_clock::now())
     , m_recompilation_engine(RecompilationEngine::GetInstance()) {
 }
 
@@ -6035,41 +6366,9 @@ u32 ppu_recompiler_llvm::ExecutionEngine::DecodeMemory(const u32 address) {
     return 0;
 }
 
-void ppu_recompiler_llvm::ExecutionEngine::RemoveUnusedEntriesFromCache() const {
-    auto now = std::chrono::high_resolution_clock::now();
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - m_last_cache_clear_time).count() > 10000) {
-        for (auto i = m_address_to_ordinal.begin(); i != m_address_to_ordinal.end();) {
-            auto tmp = i;
-            i++;
-            if (tmp->second.second == 0) {
-                m_address_to_ordinal.erase(tmp);
-            } else {
-                tmp->second.second = 0;
-            }
-        }
-
-        m_last_cache_clear_time = now;
-    }
-}
-
 Executable ppu_recompiler_llvm::ExecutionEngine::GetExecutable(u32 address, Executable default_executable) const {
-    // Find the ordinal for the specified address and insert it to the cache
-    auto i = m_address_to_ordinal.find(address);
-    if (i == m_address_to_ordinal.end()) {
-        auto ordinal = m_recompilation_engine->GetOrdinal(address);
-        if (ordinal != 0xFFFFFFFF) {
-            i = m_address_to_ordinal.insert(m_address_to_ordinal.end(), std::make_pair(address, std::make_pair(ordinal, 0)));
-        }
-    }
-
-    Executable executable = default_executable;
-    if (i != m_address_to_ordinal.end()) {
-        i->second.second++;
-        executable = m_recompilation_engine->GetExecutable(i->second.first);
-    }
-
-    RemoveUnusedEntriesFromCache();
-    return executable;
+    auto executable = m_recompilation_engine->GetExecutable(address);
+    return executable ? executable : default_executable;
 }
 
 u32 ppu_recompiler_llvm::ExecutionEngine::ExecuteFunction(PPUThread * ppu_state, u64 context) {
@@ -14,6 +14,7 @@
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/ExecutionEngine/JIT.h"
 #include "llvm/PassManager.h"
+#include <queue>
 
 namespace ppu_recompiler_llvm {
     class Compiler;
@@ -134,8 +135,12 @@ namespace ppu_recompiler_llvm {
         /// entries in the trace
         std::vector<ExecutionTraceEntry> entries;
 
+        /// Next trace in the pending trace queue of the recompilation engine
+        ExecutionTrace * next_pending;
+
         ExecutionTrace(u32 address)
-            : function_address(address) {
+            : function_address(address)
+            , next_pending(nullptr) {
         }
 
         std::string ToString() const {
@@ -942,27 +947,75 @@ namespace ppu_recompiler_llvm {
         static void InitRotateMask();
     };
 
+    /// Thread that compiles the blocks queued by the recompilation engine
+    class CompilerThread : public ThreadBase {
+    public:
+        CompilerThread(RecompilationEngine & recompilation_engine, u32 id);
+
+        CompilerThread(const CompilerThread & other) = delete;
+        CompilerThread(CompilerThread && other) = delete;
+
+        virtual ~CompilerThread();
+
+        CompilerThread & operator = (const CompilerThread & other) = delete;
+        CompilerThread & operator = (CompilerThread && other) = delete;
+
+        void Task() override;
+
+        /// The compiler used by this thread. Each compiler has its own LLVM context and module.
+        Compiler compiler;
+
+    private:
+        /// Recompilation engine
+        RecompilationEngine & m_recompilation_engine;
+    };
+
     class RecompilationEngine : public ThreadBase {
     public:
-        virtual ~RecompilationEngine();
+        /// Log stream that stays locked until the end of the statement, so compiler threads can write to the log concurrently
+        class LogWriter {
+        public:
+            LogWriter(std::unique_lock<std::mutex> && lock, llvm::raw_fd_ostream & log)
+                : m_lock(std::move(lock))
+                , m_log(log) {
+            }
+
+            LogWriter(LogWriter && other)
+                : m_lock(std::move(other.m_lock))
+                , m_log(other.m_log) {
+            }
 
-        /// Allocate an ordinal
-        u32 AllocateOrdinal(u32 address, bool is_function);
+            template<typename T>
+            LogWriter & operator << (const T & value) {
+                m_log << value;
+                return *this;
+            }
+
+        private:
+            std::unique_lock<std::mutex> m_lock;
+            llvm::raw_fd_ostream &       m_log;
+        };
 
-        /// Get the ordinal for the specified address
-        u32 GetOrdinal(u32 address) const;
+        virtual ~RecompilationEngine();
 
-        /// Get the executable specified by the ordinal
-        const Executable GetExecutable(u32 ordinal) const;
+        /// Get the executable lookup entry of a block, creating it if necessary.
+        /// The address of the entry never changes, so generated code can load the executable from it directly.
+        std::atomic<Executable> * AllocateExecutable(u32 address, bool is_function);
 
-        /// Get the address of the executable lookup
-        u64 GetAddressOfExecutableLookup() const;
+        /// Get the executable for the specified address. Returns nullptr if there is no block at this address. Lock-free.
+        const Executable GetExecutable(u32 address) const {
+            const auto page = m_executable_lookup[address >> 16].load(std::memory_order_acquire);
+            return page ? page[(address & 0xffff) / 4].load(std::memory_order_acquire) : nullptr;
+        }
 
         /// Notify the recompilation engine about a newly detected trace. It takes ownership of the trace.
         void NotifyTrace(ExecutionTrace * execution_trace);
 
         /// Log
-        llvm::raw_fd_ostream & Log();
+        LogWriter Log();
+
+        /// Compile the queued block with the highest hit count. Returns false if the queue is empty.
+        bool CompileNextBlock(Compiler & compiler);
 
         void Task() override;
 
@@ -987,6 +1040,9 @@ namespace ppu_recompiler_llvm {
             /// Indicates whether the block has been compiled or not
             bool is_compiled;
 
+            /// Serialized CFG and code hash of the last compiled version (written to the block cache)
+            std::vector<u32> cache_record;
+
             BlockEntry(u32 start_address, u32 function_address)
                 : num_hits(0)
                 , revision(0)
@@ -1021,14 +1077,61 @@ namespace ppu_recompiler_llvm {
             };
         };
 
+        /// A block queued for compilation
+        struct CompileTask {
+            /// Block being compiled
+            BlockEntry * block;
+
+            /// Copy of the CFG of the block. The block's CFG keeps changing while the task is pending.
+            ControlFlowGraph cfg;
+
+            /// Name of the generated function
+            std::string name;
+
+            /// Executable lookup entry of the block
+            std::atomic<Executable> * executable;
+
+            /// Revision of the block being compiled
+            u32 revision;
+
+            /// Number of hits of the block when it was queued
+            u32 priority;
+
+            /// Indicates whether the block is a function
+            bool is_function;
+
+            CompileTask(BlockEntry & block_entry)
+                : block(&block_entry)
+                , cfg(block_entry.cfg) {
+            }
+
+            struct less {
+                bool operator()(const CompileTask * lhs, const CompileTask * rhs) const {
+                    return lhs->priority < rhs->priority;
+                }
+            };
+        };
+
         /// Log
         llvm::raw_fd_ostream * m_log;
 
-        /// Lock for accessing m_pending_execution_traces. TODO: Eliminate this and use a lock-free queue.
-        std::mutex m_pending_execution_traces_lock;
+        /// Lock for creating and writing the log
+        std::mutex m_log_lock;
+
+        /// Queue of execution traces pending processing. Lock-free stack pushed by the PPU threads; the engine reverses it.
+        std::atomic<ExecutionTrace *> m_pending_execution_traces;
+
+        /// Execution traces taken from m_pending_execution_traces, in the order they were pushed
+        ExecutionTrace * m_execution_traces;
 
-        /// Queue of execution traces pending processing
-        std::list<ExecutionTrace *> m_pending_execution_traces;
+        /// Lock for accessing m_compile_queue and the revision of the blocks
+        std::mutex m_compile_queue_lock;
+
+        /// Blocks waiting to be compiled, highest hit count first
+        std::priority_queue<CompileTask *, std::vector<CompileTask *>, CompileTask::less> m_compile_queue;
+
+        /// Compiler threads
+        std::vector<std::unique_ptr<CompilerThread>> m_compiler_threads;
 
         /// Block table
         std::unordered_set<BlockEntry *, BlockEntry::hash, BlockEntry::equal_to> m_block_table;
@@ -1036,21 +1139,26 @@ namespace ppu_recompiler_llvm {
         /// Execution traces that have been already encountered. Data is the list of all blocks that this trace includes.
         std::unordered_map<ExecutionTrace::Id, std::vector<BlockEntry *>> m_processed_execution_traces;
 
-        /// Lock for accessing m_address_to_ordinal.
-        // TODO: Make this a RW lock
-        mutable std::mutex m_address_to_ordinal_lock;
+        /// Lock for allocating executable lookup entries
+        std::mutex m_executable_lookup_lock;
+
+        /// Number of allocated executable lookup entries
+        u32 m_num_executables;
+
+        /// Executable lookup table indexed by address. Each page holds the entries of 64 KB of guest code and is allocated on first use.
+        std::atomic<std::atomic<Executable> *> m_executable_lookup[0x10000];
 
-        /// Mapping from address to ordinal
-        std::unordered_map<u32, u32> m_address_to_ordinal;
+        /// Blocks loaded from the block cache whose code is not in memory yet (owned until they're moved to m_block_table)
+        std::vector<BlockEntry *> m_cache_pending_blocks;
 
-        /// Next ordinal to allocate
-        u32 m_next_ordinal;
+        /// Number of blocks loaded from the block cache
+        u32 m_cache_loaded_blocks;
 
-        /// PPU Compiler
-        Compiler m_compiler;
+        /// Time at which the recompilation engine started
+        std::chrono::high_resolution_clock::time_point m_start_time;
 
-        /// Executable lookup table
-        Executable m_executable_lookup[10000]; // TODO: Adjust size
+        /// Time from the start of the recompilation engine till the first block was compiled
+        std::chrono::nanoseconds m_first_block_time;
 
         RecompilationEngine();
 
@@ -1066,9 +1174,30 @@ namespace ppu_recompiler_llvm {
         /// Update a CFG
         void UpdateControlFlowGraph(ControlFlowGraph & cfg, const ExecutionTraceEntry & this_entry, const ExecutionTraceEntry * next_entry);
 
-        /// Compile a block
+        /// Queue a block for compilation
         void CompileBlock(BlockEntry & block_entry);
 
+        /// Create the compiler threads
+        void StartCompilerThreads();
+
+        /// Stop the compiler threads and discard the queued blocks
+        void StopCompilerThreads();
+
+        /// Load the blocks compiled by a previous run and compile the ones whose code is unchanged
+        void LoadBlockCache();
+
+        /// Compile pending blocks from the block cache whose code has been loaded. Returns true if any block was processed.
+        bool ProcessPendingCacheBlocks();
+
+        /// Save the CFGs of all compiled blocks to the block cache
+        void SaveBlockCache();
+
+        /// Serialize a CFG along with the hash of its code and CFG. Returns false if the code is not in memory.
+        static bool SerializeBlock(const ControlFlowGraph & cfg, std::vector<u32> & record);
+
+        /// Get the path of the block cache
+        static std::string GetBlockCachePath();
+
         /// Mutex used to prevent multiple creation
         static std::mutex s_mutex;
 
@@ -1143,18 +1272,9 @@ namespace ppu_recompiler_llvm {
         /// Execution tracer
         Tracer m_tracer;
 
-        /// The time at which the m_address_to_ordinal cache was last cleared
-        mutable std::chrono::high_resolution_clock::time_point m_last_cache_clear_time;
-
-        /// Address to ordinal cahce. Key is address. Data is the pair (ordinal, times hit).
-        mutable std::unordered_map<u32, std::pair<u32, u32>> m_address_to_ordinal;
-
         /// Recompilation engine
         std::shared_ptr<RecompilationEngine> m_recompilation_engine;
 
-        /// Remove unused entries from the m_address_to_ordinal cache
-        void RemoveUnusedEntriesFromCache() const;
-
         /// Get the executable for the specified address
         Executable GetExecutable(u32 address, Executable default_executable) const;
 
@@ -8,6 +8,7 @@
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/SysCalls/Static.h"
 #include "Emu/Cell/PPUDecoder.h"
+#include "Emu/Cell/PPUCachedDecoder.h"
 #include "Emu/Cell/PPUInterpreter.h"
 #include "Emu/Cell/PPULLVMRecompiler.h"
 //#include "Emu/Cell/PPURecompiler.h"
@@ -27,6 +28,10 @@ PPUThread& GetCurrentPPUThread()
 PPUThread::PPUThread() : PPCThread(CPU_THREAD_PPU)
 {
 	owned_mutexes = 0;
+	sched_running = false;
+	sched_order = 0;
+	sched_preempt = false;
+	joiner = 0;
 	Reset();
 }
 
@@ -128,7 +133,9 @@ void PPUThread::DoRun()
 #endif
 	break;
 
-	//case 3: m_dec = new PPURecompiler(*this); break;
+	case 3:
+		m_dec = new PPUCachedDecoder(new PPUInterpreter(*this));
+	break;
 
 	default:
 		LOG_ERROR(PPU, "Invalid CPU decoder mode: %d", Ini.CPUDecoderMode.GetValue());
@@ -224,15 +231,31 @@ void PPUThread::FastStop()
 	m_status = Stopped;
 }
 
+void PPUThread::Step()
+{
+	if (sched_preempt.load(std::memory_order_relaxed))
+	{
+		Emu.GetCPU().PPUYield(*this);
+	}
+}
+
 void PPUThread::Task()
 {
 	if (custom_task)
 	{
+		// HLE threads aren't limited by the scheduler
 		custom_task(*this);
 	}
 	else
 	{
+		Emu.GetCPU().PPUAcquire(*this);
 		CPUThread::Task();
+		Emu.GetCPU().PPURelease(*this);
+	}
+
+	if (const u32 id = joiner.exchange(0))
+	{
+		Emu.GetCPU().NotifyThread(id);
 	}
 }
 
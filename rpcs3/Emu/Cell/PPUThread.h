@@ -541,10 +541,18 @@ public:
 
 	u64 R_ADDR; // reservation address
 	u64 R_VALUE; // reservation value (BE)
+	u64 R_STAMP; // reservation line stamp (see vm::reservation_acquire)
 
 	u32 owned_mutexes;
 	std::function<void(PPUThread& CPU)> custom_task;
 
+	// scheduler state (protected by the scheduler mutex, see CPUThreadManager::PPUAcquire)
+	bool sched_running; // the thread holds a slot
+	u64 sched_order; // position in the ready queue among threads of equal priority
+	std::atomic<bool> sched_preempt; // set when a waiting thread asks this one to yield
+
+	std::atomic<u32> joiner; // id of the thread waiting in sys_ppu_thread_join()
+
 public:
 	PPUThread();
 	virtual ~PPUThread();
@@ -812,6 +820,7 @@ protected:
 	virtual void DoPause() override;
 	virtual void DoResume() override;
 	virtual void DoStop() override;
+	virtual void Step() override;
 };
 
 PPUThread& GetCurrentPPUThread();
@@ -1,4 +1,7 @@
 #pragma once
+#include <unordered_map>
+#include <map>
+#include <deque>
 
 #define ASMJIT_STATIC
 
@@ -11,6 +14,36 @@ using namespace asmjit::host;
 
 class SPURecompiler;
 
+// compiled SPU code shared by all SPU threads (identical code at the same LS position is compiled once)
+struct SPURecompilerCache
+{
+	struct Block
+	{
+		std::vector<u32> code; // LS words covered by the block (as stored in LS)
+		u16 count;
+		void* pointer;
+		u32 refs;
+	};
+
+	std::mutex mutex; // protects everything (JitRuntime isn't thread-safe)
+	JitRuntime runtime;
+	std::unordered_map<u64, std::vector<Block>> blocks; // key: start position and first opcode
+
+	// constants used by compiled code; capacity is reserved so it's never reallocated while in use
+	std::vector<__m128i> imm_table;
+	std::map<std::pair<u64, u64>, u32> imm_index;
+	std::deque<__m128i> imm_overflow; // constants that didn't fit in imm_table (addressed directly, never moved)
+
+	SPURecompilerCache();
+
+	static u64 GetKey(u16 pos, u32 opcode) { return (u64)pos << 32 | opcode; }
+
+	Block* Find(u16 pos, const u32* ls);
+	void Release(u16 pos, u32 opcode, void* pointer);
+};
+
+extern SPURecompilerCache g_spu_cache;
+
 class SPURecompilerCore : public CPUDecoder
 {
 	SPURecompiler* m_enc;
@@ -18,7 +51,6 @@ class SPURecompilerCore : public CPUDecoder
 
 public:
 	SPUInterpreter* inter;
-	JitRuntime runtime;
 	bool first;
 	bool need_check;
 
@@ -28,6 +60,7 @@ public:
 		u16 count; // count of instructions compiled from current point (and to be checked)
 		u32 valid; // copy of valid opcode for validation
 		void* pointer; // pointer to executable memory object
+		u32 opcode; // first opcode of the block (cache key)
 #ifdef _WIN32
 		//_IMAGE_RUNTIME_FUNCTION_ENTRY info;
 #endif
@@ -35,7 +68,7 @@ public:
 
 	SPURecEntry entry[0x10000];
 
-	std::vector<__m128i> imm_table;
+	std::vector<u16> page_blocks[0x100]; // start positions of compiled blocks overlapping each 1 KB page of LS
 
 	SPURecompilerCore(SPUThread& cpu);
 
@@ -43,6 +76,12 @@ public:
 
 	void Compile(u16 pos);
 
+	void AddBlock(u16 pos);
+
+	void ReleaseBlock(u16 pos);
+
+	void CheckDirty();
+
 	virtual void Decode(const u32 code);
 
 	virtual u32 DecodeMemory(const u32 address);
@@ -56,6 +95,7 @@ public:
 #define cpu_dword(x) dword_ptr(*cpu_var, (sizeof((*(SPUThread*)nullptr).x) == 4) ? (s32)offsetof(SPUThread, x) : throw "sizeof("#x") != 4")
 #define cpu_word(x) word_ptr(*cpu_var, (sizeof((*(SPUThread*)nullptr).x) == 2) ? (s32)offsetof(SPUThread, x) : throw "sizeof("#x") != 2")
 #define cpu_byte(x) byte_ptr(*cpu_var, (sizeof((*(SPUThread*)nullptr).x) == 1) ? (s32)offsetof(SPUThread, x) : throw "sizeof("#x") != 1")
+#define cpu_offset(x) ((s32)offsetof(SPUThread, x))
 
 #define g_imm_xmm(x) oword_ptr(*g_imm_var, (s32)offsetof(g_imm_table_struct, x))
 #define g_imm2_xmm(x, y) oword_ptr(*g_imm_var, y, 0, (s32)offsetof(g_imm_table_struct, x))
@@ -65,6 +105,7 @@ public:
 #define cpu_dword(x) dword_ptr(*cpu_var, reinterpret_cast<uintptr_t>(&(((SPUThread*)0)->x)) )
 #define cpu_word(x) word_ptr(*cpu_var, reinterpret_cast<uintptr_t>(&(((SPUThread*)0)->x)) )
 #define cpu_byte(x) byte_ptr(*cpu_var, reinterpret_cast<uintptr_t>(&(((SPUThread*)0)->x)) )
+#define cpu_offset(x) ((s32)reinterpret_cast<uintptr_t>(&(((SPUThread*)0)->x)))
 
 #define g_imm_xmm(x) oword_ptr(*g_imm_var, reinterpret_cast<uintptr_t>(&(((g_imm_table_struct*)0)->x)))
 #define g_imm2_xmm(x, y) oword_ptr(*g_imm_var, y, 0, reinterpret_cast<uintptr_t>(&(((g_imm_table_struct*)0)->x)))
@@ -354,15 +395,34 @@ public:
 
 	Mem XmmConst(const __m128i& data)
 	{
-		for (u32 i = 0; i < rec.imm_table.size(); i++)
+		// called with g_spu_cache.mutex locked
+		auto& table = g_spu_cache.imm_table;
+		const auto key = std::make_pair(mmToU64Ptr(data)[0], mmToU64Ptr(data)[1]);
+
+		auto found = g_spu_cache.imm_index.find(key);
+		if (found != g_spu_cache.imm_index.end())
+		{
+			return oword_ptr(*imm_var, found->second * sizeof(__m128i));
+		}
+
+		if (table.size() == table.capacity())
 		{
-			if (mmToU64Ptr(rec.imm_table[i])[0] == mmToU64Ptr(data)[0] && mmToU64Ptr(rec.imm_table[i])[1] == mmToU64Ptr(data)[1])
+			// table can't grow (compiled code addresses it through imm_var), so the constant is loaded from its own address
+			if (g_spu_cache.imm_overflow.empty())
 			{
-				return oword_ptr(*imm_var, i * sizeof(__m128i));
+				LOG_WARNING(Log::SPU, "SPURecompiler::XmmConst(): constant table is full");
 			}
+
+			g_spu_cache.imm_overflow.push_back(data);
+
+			X86GpVar addr(c, kVarTypeIntPtr);
+			c.mov(addr, imm_ptr(&g_spu_cache.imm_overflow.back()));
+			return oword_ptr(addr);
 		}
-		const size_t shift = rec.imm_table.size() * sizeof(__m128i);
-		rec.imm_table.push_back(data);
+
+		const size_t shift = table.size() * sizeof(__m128i);
+		g_spu_cache.imm_index[key] = (u32)table.size();
+		table.push_back(data);
 		return oword_ptr(*imm_var, (s32)shift);
 	}
 
@@ -1185,6 +1245,11 @@ private:
 		c.mov(qword_ptr(*ls_var, *addr, 0, 0), *qw1);
 		c.mov(qword_ptr(*ls_var, *addr, 0, 8), *qw0);
 
+		// mark LS page as modified
+		c.shr(*addr, 10);
+		c.mov(byte_ptr(*cpu_var, *addr, 0, cpu_offset(ls_dirty[0])), 1);
+		c.mov(cpu_dword(ls_dirty_any), 1);
+
 		LOG_OPCODE();
 	}
 	void BI(u32 intr, u32 ra)
@@ -2770,6 +2835,10 @@ private:
 		c.mov(qword_ptr(*ls_var, lsa), *qw1);
 		c.mov(qword_ptr(*ls_var, lsa + 8), *qw0);
 
+		// mark LS page as modified
+		c.mov(cpu_byte(ls_dirty[lsa >> 10]), 1);
+		c.mov(cpu_dword(ls_dirty_any), 1);
+
 		LOG_OPCODE();
 	}
 	void BRNZ(u32 rt, s32 i16)
@@ -2821,6 +2890,10 @@ private:
 		c.mov(qword_ptr(*ls_var, lsa), *qw1);
 		c.mov(qword_ptr(*ls_var, lsa + 8), *qw0);
 
+		// mark LS page as modified
+		c.mov(cpu_byte(ls_dirty[lsa >> 10]), 1);
+		c.mov(cpu_dword(ls_dirty_any), 1);
+
 		LOG_OPCODE();
 	}
 	void BRA(s32 i16)
@@ -3265,6 +3338,11 @@ private:
 		c.mov(qword_ptr(*ls_var, *addr, 0, 0), *qw1);
 		c.mov(qword_ptr(*ls_var, *addr, 0, 8), *qw0);
 
+		// mark LS page as modified
+		c.shr(*addr, 10);
+		c.mov(byte_ptr(*cpu_var, *addr, 0, cpu_offset(ls_dirty[0])), 1);
+		c.mov(cpu_dword(ls_dirty_any), 1);
+
 		LOG_OPCODE();
 	}
 	void LQD(u32 rt, s32 i10, u32 ra) // i10 is shifted left by 4 while decoding
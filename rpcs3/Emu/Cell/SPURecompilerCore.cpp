@@ -15,6 +15,56 @@
 
 const g_imm_table_struct g_imm_table;
 
+SPURecompilerCache g_spu_cache;
+
+SPURecompilerCache::SPURecompilerCache()
+{
+	imm_table.reserve(0x10000);
+}
+
+SPURecompilerCache::Block* SPURecompilerCache::Find(u16 pos, const u32* ls)
+{
+	auto found = blocks.find(GetKey(pos, ls[pos]));
+	if (found == blocks.end())
+	{
+		return nullptr;
+	}
+
+	for (auto& block : found->second)
+	{
+		if (pos + block.code.size() <= 0x10000 && memcmp(block.code.data(), ls + pos, block.code.size() * sizeof(u32)) == 0)
+		{
+			return &block;
+		}
+	}
+
+	return nullptr;
+}
+
+void SPURecompilerCache::Release(u16 pos, u32 opcode, void* pointer)
+{
+	auto found = blocks.find(GetKey(pos, opcode));
+	if (found == blocks.end())
+	{
+		return;
+	}
+
+	auto& list = found->second;
+	for (auto it = list.begin(); it != list.end(); it++)
+	{
+		if (it->pointer == pointer)
+		{
+			if (!--it->refs)
+			{
+				runtime.release(it->pointer);
+				list.erase(it);
+				if (list.empty()) blocks.erase(found);
+			}
+			return;
+		}
+	}
+}
+
 SPURecompilerCore::SPURecompilerCore(SPUThread& cpu)
 	: m_enc(new SPURecompiler(cpu, *this))
 	, inter(new SPUInterpreter(cpu))
@@ -23,6 +73,8 @@ SPURecompilerCore::SPURecompilerCore(SPUThread& cpu)
 	, need_check(false)
 {
 	memset(entry, 0, sizeof(entry));
+	memset(CPU.ls_dirty, 0, sizeof(CPU.ls_dirty));
+	CPU.ls_dirty_any = 0;
 	X86CpuInfo inf;
 	X86CpuUtil::detect(&inf);
 	if (!inf.hasFeature(kX86CpuFeatureSSE4_1))
@@ -34,6 +86,18 @@ SPURecompilerCore::SPURecompilerCore(SPUThread& cpu)
 
 SPURecompilerCore::~SPURecompilerCore()
 {
+	{
+		std::lock_guard<std::mutex> lock(g_spu_cache.mutex);
+
+		for (u32 i = 0; i < 0x10000; i++)
+		{
+			if (entry[i].pointer)
+			{
+				g_spu_cache.Release(i, entry[i].opcode, entry[i].pointer);
+			}
+		}
+	}
+
 	delete m_enc;
 	delete inter;
 }
@@ -45,6 +109,27 @@ void SPURecompilerCore::Decode(const u32 code) // decode instruction and run wit
 
 void SPURecompilerCore::Compile(u16 pos)
 {
+	std::lock_guard<std::mutex> lock(g_spu_cache.mutex);
+
+	const u32* ls = vm::get_ptr<u32>(CPU.ls_offset);
+
+	// reuse the code compiled by another thread (or by this thread before invalidation)
+	if (auto block = g_spu_cache.Find(pos, ls))
+	{
+		block->refs++;
+		entry[pos].pointer = block->pointer;
+		entry[pos].count = block->count;
+		entry[pos].opcode = block->code[0];
+
+		for (u32 i = 0; i < block->code.size(); i++)
+		{
+			entry[pos + i].valid = block->code[i];
+		}
+
+		AddBlock(pos);
+		return;
+	}
+
 	const u64 stamp0 = get_system_time();
 	u64 time0 = 0;
 
@@ -54,7 +139,7 @@ void SPURecompilerCore::Compile(u16 pos)
 	StringLogger stringLogger;
 	stringLogger.setOption(kLoggerOptionBinaryForm, true);
 
-	X86Compiler compiler(&runtime);
+	X86Compiler compiler(&g_spu_cache.runtime);
 	m_enc->compiler = &compiler;
 	compiler.setLogger(&stringLogger);
 
@@ -154,6 +239,19 @@ void SPURecompilerCore::Compile(u16 pos)
 	entry[start].pointer = compiler.make();
 	compiler.setLogger(nullptr); // crashes without it
 
+	if (entry[start].pointer)
+	{
+		SPURecompilerCache::Block block;
+		block.code.assign(ls + start, ls + pos + 1);
+		block.count = entry[start].count;
+		block.pointer = entry[start].pointer;
+		block.refs = 1;
+
+		entry[start].opcode = ls[start];
+		g_spu_cache.blocks[SPURecompilerCache::GetKey(start, ls[start])].push_back(block);
+		AddBlock(start);
+	}
+
 	rFile log;
 	log.Open(fmt::Format("SPUjit_%d.log", GetCurrentSPUThread().GetId()), first ? rFile::write : rFile::write_append);
 	log.Write(fmt::Format("========== START POSITION 0x%x ==========\n\n", start * 4));
@@ -180,57 +278,119 @@ void SPURecompilerCore::Compile(u16 pos)
 	first = false;
 }
 
-u32 SPURecompilerCore::DecodeMemory(const u32 address)
+void SPURecompilerCore::AddBlock(u16 pos)
 {
-	assert(CPU.ls_offset == address - CPU.PC);
-	const u32 m_offset = CPU.ls_offset;
-	const u16 pos = (u16)(CPU.PC >> 2);
+	const u32 last = pos + std::max<u32>(entry[pos].count, 1) - 1;
 
-	//ConLog.Write("DecodeMemory: pos=%d", pos);
-	u32* ls = vm::get_ptr<u32>(m_offset);
+	for (u32 page = pos >> 8; page <= (last >> 8); page++)
+	{
+		page_blocks[page].push_back(pos);
+	}
+}
+
+void SPURecompilerCore::ReleaseBlock(u16 pos)
+{
+	if (!entry[pos].pointer) return;
+
+	const u32 count = std::max<u32>(entry[pos].count, 1);
+
+	{
+		std::lock_guard<std::mutex> lock(g_spu_cache.mutex);
+		g_spu_cache.Release(pos, entry[pos].opcode, entry[pos].pointer);
+	}
 
-	if (entry[pos].pointer)
+#ifdef _WIN32
+	//RtlDeleteFunctionTable(&entry[pos].info);
+#endif
+	entry[pos].pointer = nullptr;
+
+	for (u32 page = pos >> 8; page <= ((pos + count - 1) >> 8); page++)
 	{
-		// check data (hard way)
-		bool is_valid = true;
-		if (need_check)
+		auto& list = page_blocks[page];
+		list.erase(std::remove(list.begin(), list.end(), pos), list.end());
+	}
+
+	for (u32 j = pos; j < pos + count; j++)
+	{
+		entry[j].valid = 0;
+	}
+
+	// release other blocks sharing these instructions (their validation data has just been cleared)
+	for (u32 page = pos >> 8; page <= ((pos + count - 1) >> 8); page++)
+	{
+		const std::vector<u16> list = page_blocks[page];
+
+		for (u16 start : list)
 		{
-			for (u32 i = 0; i < 0x10000; i++)
+			if (start < pos + count && start + std::max<u32>(entry[start].count, 1) > pos)
 			{
-				if (entry[i].valid && entry[i].valid != ls[i])
-				{
-					is_valid = false;
-					break;
-				}
+				ReleaseBlock(start);
 			}
-			need_check = false;
 		}
-		// invalidate if necessary
-		if (!is_valid)
+	}
+}
+
+void SPURecompilerCore::CheckDirty()
+{
+	if (need_check && CPU.GetType() == CPU_THREAD_RAW_SPU)
+	{
+		// PPU can write raw SPU LS directly, so SYNC must check everything
+		memset(CPU.ls_dirty, 1, sizeof(CPU.ls_dirty));
+		CPU.ls_dirty_any = 1;
+	}
+
+	need_check = false;
+
+	if (!CPU.ls_dirty_any) return;
+
+	CPU.ls_dirty_any = 0;
+
+	const u32* ls = vm::get_ptr<u32>(CPU.ls_offset);
+
+	for (u32 page = 0; page < 0x100; page++)
+	{
+		// skip 8 clean pages at once
+		if (!(page % 8) && !*(u64*)(CPU.ls_dirty + page))
 		{
-			for (u32 i = 0; i < 0x10000; i++)
-			{
-				if (!entry[i].pointer) continue;
+			page += 7;
+			continue;
+		}
+
+		if (!CPU.ls_dirty[page]) continue;
 
-				if (!entry[i].valid || entry[i].valid != ls[i] ||
-					i + (u32)entry[i].count > (u32)pos &&
-					i < (u32)pos + (u32)entry[pos].count)
+		CPU.ls_dirty[page] = 0;
+
+		if (page_blocks[page].empty()) continue;
+
+		// check only instructions of this page, release blocks containing modified ones
+		for (u32 i = page << 8; i < (page + 1) << 8; i++)
+		{
+			if (!entry[i].valid || entry[i].valid == ls[i]) continue;
+
+			const std::vector<u16> list = page_blocks[page];
+
+			for (u16 start : list)
+			{
+				if (start <= i && start + std::max<u32>(entry[start].count, 1) > i)
 				{
-					runtime.release(entry[i].pointer);
-#ifdef _WIN32
-					//RtlDeleteFunctionTable(&entry[i].info);
-#endif
-					entry[i].pointer = nullptr;
-					for (u32 j = i; j < i + (u32)entry[i].count; j++)
-					{
-						entry[j].valid = 0;
-					}
-					//need_check = true;
+					ReleaseBlock(start);
 				}
 			}
-			//LOG_ERROR(Log::SPU, "SPURecompilerCore::DecodeMemory(ls=0x%x): code has changed", pos * sizeof(u32));
+
+			//LOG_ERROR(Log::SPU, "SPURecompilerCore::CheckDirty(ls=0x%x): code has changed", i * sizeof(u32));
 		}
 	}
+}
+
+u32 SPURecompilerCore::DecodeMemory(const u32 address)
+{
+	assert(CPU.ls_offset == address - CPU.PC);
+	const u32 m_offset = CPU.ls_offset;
+	const u16 pos = (u16)(CPU.PC >> 2);
+
+	//ConLog.Write("DecodeMemory: pos=%d", pos);
+
+	CheckDirty();
 
 	bool did_compile = false;
 	if (!entry[pos].pointer)
@@ -264,7 +424,7 @@ u32 SPURecompilerCore::DecodeMemory(const u32 address)
 	}
 
 	u32 res = pos;
-	res = func(cpu, vm::get_ptr<void>(m_offset), imm_table.data(), &g_imm_table);
+	res = func(cpu, vm::get_ptr<void>(m_offset), g_spu_cache.imm_table.data(), &g_imm_table);
 
 	if (res & 0x1000000)
 	{
@@ -2,6 +2,7 @@
 #include "rpcs3/Ini.h"
 #include "Utilities/Log.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/Memory/vm_reservation.h"
 #include "Emu/System.h"
 #include "Emu/Memory/atomic_type.h"
 
@@ -33,7 +34,9 @@ SPUThread& GetCurrentSPUThread()
 	return *(SPUThread*)thread;
 }
 
-SPUThread::SPUThread(CPUThreadType type) : PPCThread(type)
+SPUThread::SPUThread(CPUThreadType type)
+	: PPCThread(type)
+	, m_dmac([this](const DMACCommand& c){ ProcessCmd(c.cmd, c.tag, c.lsa, c.ea, c.size); }, [this](u32 status){ MFC1.TagStatus.PushUncond(status); })
 {
 	assert(type == CPU_THREAD_SPU || type == CPU_THREAD_RAW_SPU);
 
@@ -48,6 +51,7 @@ SPUThread::SPUThread(CPUThreadType type) : PPCThread(type)
 
 SPUThread::~SPUThread()
 {
+	m_dmac.Stop();
 }
 
 void SPUThread::Task()
@@ -77,6 +81,9 @@ void SPUThread::DoReset()
 
 	//reset regs
 	memset(GPR, 0, sizeof(u128) * 128);
+
+	memset(ls_dirty, 0, sizeof(ls_dirty));
+	ls_dirty_any = 0;
 }
 
 void SPUThread::InitRegs()
@@ -128,6 +135,8 @@ void SPUThread::DoPause()
 
 void SPUThread::DoStop()
 {
+	m_dmac.Stop();
+
 	delete m_dec;
 	m_dec = nullptr;
 }
@@ -220,6 +229,11 @@ void SPUThread::ProcessCmd(u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size)
 			{
 				// LS access
 				ea = ((SPUThread*)spu.get())->ls_offset + addr;
+
+				if (cmd & MFC_PUT_CMD)
+				{
+					((SPUThread*)spu.get())->MarkLSDirty(addr, size);
+				}
 			}
 			else if ((cmd & MFC_PUT_CMD) && size == 4 && (addr == SYS_SPU_THREAD_SNR1 || addr == SYS_SPU_THREAD_SNR2))
 			{
@@ -269,13 +283,14 @@ void SPUThread::ProcessCmd(u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size)
 	{
 	case MFC_PUT_CMD:
 	{
-		memcpy(vm::get_ptr<void>((u32)ea), vm::get_ptr<void>(ls_offset + lsa), size);
+		DMAC::Copy(vm::get_ptr<void>((u32)ea), vm::get_ptr<void>(ls_offset + lsa), size);
 		return;
 	}
 
 	case MFC_GET_CMD:
 	{
 		memcpy(vm::get_ptr<void>(ls_offset + lsa), vm::get_ptr<void>((u32)ea), size);
+		MarkLSDirty(lsa, size);
 		return;
 	}
 
@@ -290,6 +305,19 @@ void SPUThread::ProcessCmd(u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size)
 
 #undef LOG_CMD
 
+void SPUThread::DMATransfer(MFCReg& MFCArgs, u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size)
+{
+	if (&MFCArgs == &MFC1)
+	{
+		m_dmac.Enqueue({ cmd, tag, lsa, ea, size });
+	}
+	else
+	{
+		// RawSPU MFC_QStatus doesn't track proxy commands
+		ProcessCmd(cmd, tag, lsa, ea, size);
+	}
+}
+
 void SPUThread::ListCmd(u32 lsa, u64 ea, u16 tag, u16 size, u32 cmd, MFCReg& MFCArgs)
 {
 	const u32 list_addr = ea & 0x3ffff;
@@ -303,38 +331,68 @@ void SPUThread::ListCmd(u32 lsa, u64 ea, u16 tag, u16 size, u32 cmd, MFCReg& MFC
 		be_t<u32> ea; // External Address Low
 	};
 
+	const list_element* list = vm::get_ptr<list_element>(ls_offset + list_addr);
+
 	u32 result = MFC_PPU_DMA_CMD_ENQUEUE_SUCCESSFUL;
 
+	// elements which are contiguous both in LS and in memory are merged into one transfer
+	u32 merged_lsa = 0, merged_ea = 0, merged_size = 0;
+
 	for (u32 i = 0; i < list_size; i++)
 	{
-		auto rec = vm::ptr<list_element>::make(ls_offset + list_addr + i * 8);
+		const list_element& rec = list[i];
+		const bool stall = (rec.s.data() & se16(0x8000)) != 0;
 
-		const u32 size = rec->ts;
-		if (!(rec->s.data() & se16(0x8000)) && size < 16 && size != 1 && size != 2 && size != 4 && size != 8)
+		const u32 size = rec.ts;
+		if (!stall && size < 16 && size != 1 && size != 2 && size != 4 && size != 8)
 		{
 			LOG_ERROR(Log::SPU, "DMA List: invalid transfer size(%d)", size);
 			result = MFC_PPU_DMA_CMD_SEQUENCE_ERROR;
 			break;
 		}
 
-		const u32 addr = rec->ea;
-		if (size)
-		{
-			ProcessCmd(cmd, tag, lsa | (addr & 0xf), addr, size);
-		}
+		const u32 addr = rec.ea;
+		const u32 elem_lsa = lsa | (addr & 0xf);
 
-		if (Ini.HLELogging.GetValue() || rec->s.data())
+		if (Ini.HLELogging.GetValue() || rec.s.data())
 		{
-			LOG_NOTICE(Log::SPU, "*** list element(%d/%d): s = 0x%x, ts = 0x%x, low ea = 0x%x (lsa = 0x%x)", i, list_size, rec->s, rec->ts, rec->ea, lsa | (addr & 0xf));
+			LOG_NOTICE(Log::SPU, "*** list element(%d/%d): s = 0x%x, ts = 0x%x, low ea = 0x%x (lsa = 0x%x)", i, list_size, rec.s, rec.ts, rec.ea, elem_lsa);
 		}
 
 		if (size)
 		{
+			// MMIO accesses are never merged
+			if (merged_size && merged_ea + merged_size == addr && merged_lsa + merged_size == elem_lsa &&
+				elem_lsa + size <= 0x40000 && (u64)addr + size <= RAW_SPU_BASE_ADDR)
+			{
+				merged_size += size;
+			}
+			else
+			{
+				if (merged_size)
+				{
+					DMATransfer(MFCArgs, cmd, tag, merged_lsa, merged_ea, merged_size);
+				}
+
+				merged_lsa = elem_lsa;
+				merged_ea = addr;
+				merged_size = size;
+			}
+
 			lsa += std::max<u32>(size, 16);
 		}
 
-		if (rec->s.data() & se16(0x8000))
+		if (stall)
 		{
+			if (merged_size)
+			{
+				DMATransfer(MFCArgs, cmd, tag, merged_lsa, merged_ea, merged_size);
+				merged_size = 0;
+			}
+
+			// the element must be transferred before the notification
+			m_dmac.Drain();
+
 			StallStat.PushUncond_OR(1 << tag);
 
 			if (StallList[tag].MFCArgs)
@@ -353,6 +411,11 @@ void SPUThread::ListCmd(u32 lsa, u64 ea, u16 tag, u16 size, u32 cmd, MFCReg& MFC
 		}
 	}
 
+	if (merged_size)
+	{
+		DMATransfer(MFCArgs, cmd, tag, merged_lsa, merged_ea, merged_size);
+	}
+
 	MFCArgs.CMDStatus.SetValue(result);
 }
 
@@ -380,7 +443,7 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 			(op & MFC_FENCE_MASK ? "F" : ""),
 			lsa, ea, tag, size, cmd);
 
-		ProcessCmd(cmd, tag, lsa, ea, size);
+		DMATransfer(MFCArgs, cmd, tag, lsa, ea, size);
 		MFCArgs.CMDStatus.SetValue(MFC_PPU_DMA_CMD_ENQUEUE_SUCCESSFUL);
 		break;
 	}
@@ -411,6 +474,9 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 			op == MFC_PUTLLUC_CMD ? "PUTLLUC" : "PUTQLLUC"),
 			lsa, ea, tag, size, cmd);
 
+		// atomic commands aren't queued, but previous transfers may still be in flight
+		m_dmac.Drain();
+
 		if ((u32)ea != ea)
 		{
 			LOG_ERROR(Log::SPU, "DMA %s: Invalid external address (0x%llx)",
@@ -422,6 +488,10 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 			return;
 		}
 
+		// the lowest 7 bits are ignored
+		const u32 line_addr = (u32)ea & ~0x7f;
+		const u32 line_lsa = lsa & 0x3ff80;
+
 		if (op == MFC_GETLLAR_CMD) // get reservation
 		{
 			if (R_ADDR)
@@ -429,83 +499,46 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 				m_events |= SPU_EVENT_LR;
 			}
 
-			R_ADDR = ea;
-			for (u32 i = 0; i < 16; i++)
-			{
-				R_DATA[i] = vm::get_ptr<u64>((u32)R_ADDR)[i];
-				vm::get_ptr<u64>(ls_offset + lsa)[i] = R_DATA[i];
-			}
+			R_ADDR = line_addr;
+			R_STAMP = vm::reservation_acquire(R_DATA, line_addr, 128);
+			memcpy(vm::get_ptr<void>(ls_offset + line_lsa), R_DATA, 128);
+			MarkLSDirty(line_lsa, 128);
 			MFCArgs.AtomicStat.PushUncond(MFC_GETLLAR_SUCCESS);
 		}
 		else if (op == MFC_PUTLLC_CMD) // store conditional
 		{
-			MFCArgs.AtomicStat.PushUncond(MFC_PUTLLC_SUCCESS);
-
-			if (R_ADDR == ea)
+			const bool success = R_ADDR == line_addr && vm::reservation_update(line_addr, R_STAMP, [&]()
 			{
-				u32 changed = 0, mask = 0;
-				u64 buf[16];
-				for (u32 i = 0; i < 16; i++)
-				{
-					buf[i] = vm::get_ptr<u64>(ls_offset + lsa)[i];
-					if (buf[i] != R_DATA[i])
-					{
-						changed++;
-						mask |= (0x3 << (i * 2));
-						if (vm::get_ptr<u64>((u32)R_ADDR)[i] != R_DATA[i])
-						{
-							m_events |= SPU_EVENT_LR;
-							MFCArgs.AtomicStat.PushUncond(MFC_PUTLLC_FAILURE);
-							R_ADDR = 0;
-							return;
-						}
-					}
-				}
+				// plain stores and HLE atomics don't take the line lock, so only the changed words are written (each with CAS)
+				const auto mem = vm::get_ptr<volatile u64>(line_addr);
+				const auto buf = vm::get_ptr<u64>(ls_offset + line_lsa);
 
 				for (u32 i = 0; i < 16; i++)
 				{
-					if (buf[i] != R_DATA[i])
+					if (buf[i] != R_DATA[i] && InterlockedCompareExchange(&mem[i], buf[i], R_DATA[i]) != R_DATA[i])
 					{
-						if (InterlockedCompareExchange(&vm::get_ptr<volatile u64>((u32)R_ADDR)[i], buf[i], R_DATA[i]) != R_DATA[i])
+						// undo the words already written (unless they were modified again)
+						while (i--)
 						{
-							m_events |= SPU_EVENT_LR;
-							MFCArgs.AtomicStat.PushUncond(MFC_PUTLLC_FAILURE);
-
-							if (changed > 1)
+							if (buf[i] != R_DATA[i])
 							{
-								LOG_ERROR(Log::SPU, "MFC_PUTLLC_CMD: Memory corrupted (~x%d (mask=0x%x)) (opcode=0x%x, cmd=0x%x, lsa = 0x%x, ea = 0x%llx, tag = 0x%x, size = 0x%x)",
-									changed, mask, op, cmd, lsa, ea, tag, size);
-								Emu.Pause();
+								InterlockedCompareExchange(&mem[i], R_DATA[i], buf[i]);
 							}
-							
-							break;
 						}
+
+						return false;
 					}
 				}
 
-				if (changed > 1)
-				{
-					LOG_WARNING(Log::SPU, "MFC_PUTLLC_CMD: Reservation impossibru (~x%d (mask=0x%x)) (opcode=0x%x, cmd=0x%x, lsa = 0x%x, ea = 0x%llx, tag = 0x%x, size = 0x%x)",
-						changed, mask, op, cmd, lsa, ea, tag, size);
+				return true;
+			});
 
-					SPUDisAsm dis_asm(CPUDisAsm_InterpreterMode);
-					for (s32 i = (s32)PC; i < (s32)PC + 4 * 7; i += 4)
-					{
-						dis_asm.dump_pc = i;
-						dis_asm.offset = vm::get_ptr<u8>(ls_offset);
-						const u32 opcode = vm::read32(i + ls_offset);
-						(*SPU_instr::rrr_list)(&dis_asm, opcode);
-						if (i >= 0 && i < 0x40000)
-						{
-							LOG_NOTICE(Log::SPU, "*** %s", dis_asm.last_opcode.c_str());
-						}
-					}
-				}
-			}
-			else
+			if (!success && R_ADDR == line_addr)
 			{
-				MFCArgs.AtomicStat.PushUncond(MFC_PUTLLC_FAILURE);
+				m_events |= SPU_EVENT_LR;
 			}
+
+			MFCArgs.AtomicStat.PushUncond(success ? MFC_PUTLLC_SUCCESS : MFC_PUTLLC_FAILURE);
 			R_ADDR = 0;
 		}
 		else // store unconditional
@@ -515,7 +548,11 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 				m_events |= SPU_EVENT_LR;
 			}
 
-			ProcessCmd(MFC_PUT_CMD, tag, lsa, ea, 128);
+			vm::reservation_store(line_addr, [&]()
+			{
+				memcpy(vm::get_ptr<void>(line_addr), vm::get_ptr<void>(ls_offset + line_lsa), 128);
+			});
+
 			if (op == MFC_PUTLLUC_CMD)
 			{
 				MFCArgs.AtomicStat.PushUncond(MFC_PUTLLUC_SUCCESS);
@@ -525,6 +562,14 @@ void SPUThread::EnqMfcCmd(MFCReg& MFCArgs)
 		break;
 	}
 
+	case MFC_BARRIER_CMD:
+	case MFC_EIEIO_CMD:
+	case MFC_SYNC_CMD:
+	{
+		// nothing to do, commands are executed in order
+		break;
+	}
+
 	default:
 		LOG_ERROR(Log::SPU, "Unknown MFC cmd. (opcode=0x%x, cmd=0x%x, lsa = 0x%x, ea = 0x%llx, tag = 0x%x, size = 0x%x)",
 			op, cmd, lsa, ea, tag, size);
@@ -538,14 +583,11 @@ bool SPUThread::CheckEvents()
 	// SPU_EVENT_LR:
 	if (R_ADDR)
 	{
-		for (u32 i = 0; i < 16; i++)
+		// the stamp catches reservation updates, the data comparison catches plain stores
+		if (!vm::reservation_test((u32)R_ADDR, R_STAMP) || memcmp(vm::get_ptr<void>((u32)R_ADDR), R_DATA, 128))
 		{
-			if (vm::get_ptr<u64>((u32)R_ADDR)[i] != R_DATA[i])
-			{
-				m_events |= SPU_EVENT_LR;
-				R_ADDR = 0;
-				break;
-			}
+			m_events |= SPU_EVENT_LR;
+			R_ADDR = 0;
 		}
 	}
 
@@ -583,6 +625,30 @@ u32 SPUThread::GetChannelCount(u32 ch)
 	return res;
 }
 
+template<size_t max_count, typename T> bool SPUThread::WaitChannel(Channel<max_count>& channel, T test)
+{
+	if (test())
+	{
+		return true;
+	}
+
+	channel.SetWaiter(this);
+
+	while (!test())
+	{
+		if (Emu.IsStopped())
+		{
+			channel.SetWaiter(nullptr);
+			return false;
+		}
+
+		WaitForAnySignal(10); // the timeout is only a safety net
+	}
+
+	channel.SetWaiter(nullptr);
+	return true;
+}
+
 void SPUThread::WriteChannel(u32 ch, const u128& r)
 {
 	const u32 v = r._u32[3];
@@ -596,17 +662,15 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 		break;
 	case SPU_WrOutIntrMbox:
 	{
+		m_dmac.Drain();
+
 		if (!group) // if RawSPU
 		{
 			if (Ini.HLELogging.GetValue()) LOG_NOTICE(Log::SPU, "SPU_WrOutIntrMbox: interrupt(v=0x%x)", v);
-			while (!SPU.Out_IntrMBox.Push(v))
+			if (!WaitChannel(SPU.Out_IntrMBox, [&](){ return SPU.Out_IntrMBox.Push(v); }))
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-				if (Emu.IsStopped())
-				{
-					LOG_WARNING(Log::SPU, "%s(%s) aborted", __FUNCTION__, spu_ch_name[ch]);
-					return;
-				}
+				LOG_WARNING(Log::SPU, "%s(%s) aborted", __FUNCTION__, spu_ch_name[ch]);
+				return;
 			}
 			m_intrtag[2].stat |= 1;
 			if (std::shared_ptr<CPUThread> t = Emu.GetCPU().GetThread(m_intrtag[2].thread))
@@ -657,7 +721,7 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 					return;
 				}
 
-				if (!port->eq->events.push(SYS_SPU_THREAD_EVENT_USER_KEY, GetId(), ((u64)spup << 32) | (v & 0x00ffffff), data))
+				if (!port->eq->push(SYS_SPU_THREAD_EVENT_USER_KEY, GetId(), ((u64)spup << 32) | (v & 0x00ffffff), data))
 				{
 					SPU.In_MBox.PushUncond(CELL_EBUSY);
 					return;
@@ -695,7 +759,7 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 				}
 
 				// TODO: check passing spup value
-				if (!port->eq->events.push(SYS_SPU_THREAD_EVENT_USER_KEY, GetId(), ((u64)spup << 32) | (v & 0x00ffffff), data))
+				if (!port->eq->push(SYS_SPU_THREAD_EVENT_USER_KEY, GetId(), ((u64)spup << 32) | (v & 0x00ffffff), data))
 				{
 					LOG_WARNING(Log::SPU, "sys_spu_thread_throw_event(spup=%d, data0=0x%x, data1=0x%x) failed (queue is full)", spup, (v & 0x00ffffff), data);
 					return;
@@ -740,6 +804,7 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 				if (u32 target = ef->check())
 				{
 					ef->signal.push(target);
+					Emu.GetCPU().NotifyThread(target);
 				}
 				SPU.In_MBox.PushUncond(CELL_OK);
 				return;
@@ -780,6 +845,7 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 				if (u32 target = ef->check())
 				{
 					ef->signal.push(target);
+					Emu.GetCPU().NotifyThread(target);
 				}
 				return;
 			}
@@ -803,10 +869,8 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 
 	case SPU_WrOutMbox:
 	{
-		while (!SPU.Out_MBox.Push(v) && !Emu.IsStopped())
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		}
+		m_dmac.Drain(); // in case the message is sent without waiting for the tags
+		WaitChannel(SPU.Out_MBox, [&](){ return SPU.Out_MBox.Push(v); });
 		break;
 	}
 
@@ -818,7 +882,13 @@ void SPUThread::WriteChannel(u32 ch, const u128& r)
 
 	case MFC_WrTagUpdate:
 	{
-		MFC1.TagStatus.PushUncond(MFC1.QueryMask.GetValue());
+		if (v > MFC_TAG_UPDATE_ALL)
+		{
+			LOG_ERROR(Log::SPU, "MFC_WrTagUpdate: invalid value (0x%x)", v);
+		}
+
+		// MFC1.TagStatus is set when the tags complete
+		m_dmac.RequestTagUpdate(MFC1.QueryMask.GetValue(), v);
 		break;
 	}
 
@@ -920,19 +990,13 @@ void SPUThread::ReadChannel(u128& r, u32 ch)
 		break;
 	case SPU_RdInMbox:
 	{
-		while (!SPU.In_MBox.Pop(v) && !Emu.IsStopped())
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		}
+		WaitChannel(SPU.In_MBox, [&](){ return SPU.In_MBox.Pop(v); });
 		break;
 	}
 
 	case MFC_RdTagStat:
 	{
-		while (!MFC1.TagStatus.Pop(v) && !Emu.IsStopped())
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		}
+		WaitChannel(MFC1.TagStatus, [&](){ return MFC1.TagStatus.Pop(v); });
 		break;
 	}
 
@@ -946,17 +1010,11 @@ void SPUThread::ReadChannel(u128& r, u32 ch)
 	{
 		if (cfg.value & 1)
 		{
-			while (!SPU.SNR[0].Pop_XCHG(v) && !Emu.IsStopped())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-			}
+			WaitChannel(SPU.SNR[0], [&](){ return SPU.SNR[0].Pop_XCHG(v); });
 		}
 		else
 		{
-			while (!SPU.SNR[0].Pop(v) && !Emu.IsStopped())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-			}
+			WaitChannel(SPU.SNR[0], [&](){ return SPU.SNR[0].Pop(v); });
 		}
 		break;
 	}
@@ -965,36 +1023,24 @@ void SPUThread::ReadChannel(u128& r, u32 ch)
 	{
 		if (cfg.value & 2)
 		{
-			while (!SPU.SNR[1].Pop_XCHG(v) && !Emu.IsStopped())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-			}
+			WaitChannel(SPU.SNR[1], [&](){ return SPU.SNR[1].Pop_XCHG(v); });
 		}
 		else
 		{
-			while (!SPU.SNR[1].Pop(v) && !Emu.IsStopped())
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-			}
+			WaitChannel(SPU.SNR[1], [&](){ return SPU.SNR[1].Pop(v); });
 		}
 		break;
 	}
 
 	case MFC_RdAtomicStat:
 	{
-		while (!MFC1.AtomicStat.Pop(v) && !Emu.IsStopped())
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		}
+		WaitChannel(MFC1.AtomicStat, [&](){ return MFC1.AtomicStat.Pop(v); });
 		break;
 	}
 
 	case MFC_RdListStallStat:
 	{
-		while (!StallStat.Pop(v) && !Emu.IsStopped())
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		}
+		WaitChannel(StallStat, [&](){ return StallStat.Pop(v); });
 		break;
 	}
 
@@ -1012,9 +1058,25 @@ void SPUThread::ReadChannel(u128& r, u32 ch)
 
 	case SPU_RdEventStat:
 	{
-		while (!CheckEvents() && !Emu.IsStopped())
+		if (!CheckEvents())
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+			// reservation updates of the line wake this thread, plain stores are only detected by polling (so keep the short timeout)
+			const u32 line_addr = (u32)R_ADDR;
+
+			if (line_addr)
+			{
+				vm::reservation_add_waiter(this, line_addr);
+			}
+
+			while (!CheckEvents() && !Emu.IsStopped())
+			{
+				WaitForAnySignal(1);
+			}
+
+			if (line_addr)
+			{
+				vm::reservation_remove_waiter(this, line_addr);
+			}
 		}
 		v = m_events & m_event_mask;
 		break;
@@ -1041,6 +1103,9 @@ void SPUThread::ReadChannel(u128& r, u32 ch)
 
 void SPUThread::StopAndSignal(u32 code)
 {
+	// the PPU may read the results after any of these codes
+	m_dmac.Drain();
+
 	SetExitStatus(code); // exit code (not status)
 	// TODO: process interrupts for RawSPU
 
@@ -1114,6 +1179,15 @@ void SPUThread::StopAndSignal(u32 code)
 					{
 						assert(!"sys_spu_thread_receive_event() failed (I)");
 					}
+
+					if (next)
+					{
+						eq->sq.notify(next);
+					}
+					else if (eq->events.count())
+					{
+						continue; // the event was pushed while the queue was owned
+					}
 					break;
 				}
 				// fallthrough
@@ -1134,6 +1208,10 @@ void SPUThread::StopAndSignal(u32 code)
 				{
 					assert(!"sys_spu_thread_receive_event() failed (receiving)");
 				}
+				if (eq->events.count())
+				{
+					eq->sq.notify_waiting();
+				}
 				return;
 			}
 			}
@@ -1148,7 +1226,7 @@ void SPUThread::StopAndSignal(u32 code)
 				return;
 			}
 
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+			eq->sq.wait(0, 0);
 			if (Emu.IsStopped())
 			{
 				LOG_WARNING(Log::SPU, "sys_spu_thread_receive_event(spuq=0x%x) aborted", spuq);
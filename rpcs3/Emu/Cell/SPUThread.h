@@ -279,6 +279,7 @@ public:
 
 	u64 R_ADDR; // reservation address
 	u64 R_DATA[16]; // lock line data (BE)
+	u64 R_STAMP; // lock line stamp (see vm::reservation_acquire)
 
 	std::shared_ptr<EventPort> SPUPs[64]; // SPU Thread Event Ports
 	EventManager SPUQs; // SPU Queue Mapping
@@ -321,6 +322,21 @@ public:
 		atomic_t<ChannelData> m_data[max_count];
 		size_t m_push;
 		size_t m_pop;
+		std::atomic<NamedThreadBase*> m_waiter; // thread blocked on this channel (see SPUThread::WaitChannel)
+
+		__forceinline void NotifyWaiter()
+		{
+			// pairs with the store in SetWaiter(), so either the waiter sees the new data or it gets the signal
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			NamedThreadBase* waiter = m_waiter.load(std::memory_order_relaxed);
+
+			// the waiter itself pops or pushes in WaitChannel(), it doesn't need to signal itself
+			if (waiter && waiter != GetCurrentNamedThread())
+			{
+				waiter->Notify();
+			}
+		}
 
 	public:
 		__noinline Channel()
@@ -331,6 +347,12 @@ public:
 			}
 			m_push = 0;
 			m_pop = 0;
+			m_waiter = nullptr;
+		}
+
+		__forceinline void SetWaiter(NamedThreadBase* waiter)
+		{
+			m_waiter.store(waiter);
 		}
 
 		__forceinline void PopUncond(u32& res)
@@ -338,6 +360,7 @@ public:
 			res = m_data[m_pop].read_relaxed().value;
 			m_data[m_pop].write_relaxed({});
 			m_pop = (m_pop + 1) % max_count;
+			NotifyWaiter();
 		}
 
 		__forceinline bool Pop(u32& res)
@@ -348,6 +371,7 @@ public:
 				res = data.value;
 				m_data[m_pop].write_relaxed({});
 				m_pop = (m_pop + 1) % max_count;
+				NotifyWaiter();
 				return true;
 			}
 			else
@@ -363,6 +387,7 @@ public:
 			{
 				res = data.value;
 				m_pop = (m_pop + 1) % max_count;
+				NotifyWaiter();
 				return true;
 			}
 			else
@@ -375,12 +400,14 @@ public:
 		{
 			m_data[m_push]._or({ value, 1 });
 			m_push = (m_push + 1) % max_count;
+			NotifyWaiter();
 		}
 
 		__forceinline void PushUncond(const u32 value)
 		{
 			m_data[m_push].write_relaxed({ value, 1 });
 			m_push = (m_push + 1) % max_count;
+			NotifyWaiter();
 		}
 
 		__forceinline bool Push(const u32 value)
@@ -459,6 +486,8 @@ public:
 	} StallList[32];
 	Channel<1> StallStat;
 
+	DMAC m_dmac; // executes MFC1 commands
+
 	struct
 	{
 		Channel<1> Out_MBox;
@@ -481,14 +510,35 @@ public:
 
 	u32 ls_offset;
 
+	// LS pages (1 KB) written since the last check (used by the SPU recompiler to invalidate compiled code)
+	u8 ls_dirty[0x100];
+	volatile u32 ls_dirty_any;
+
+	void MarkLSDirty(u32 lsa, u32 size)
+	{
+		if (!size) return;
+
+		for (u32 i = (lsa & 0x3ffff) >> 10, end = ((lsa & 0x3ffff) + size - 1) >> 10; i <= end; i++)
+		{
+			ls_dirty[i & 0xff] = 1;
+		}
+		ls_dirty_any = 1;
+	}
+
 	void ProcessCmd(u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size);
 
+	// queue the transfer if it was issued by the SPU, proxy commands are executed immediately
+	void DMATransfer(MFCReg& MFCArgs, u32 cmd, u32 tag, u32 lsa, u64 ea, u32 size);
+
 	void ListCmd(u32 lsa, u64 ea, u16 tag, u16 size, u32 cmd, MFCReg& MFCArgs);
 
 	void EnqMfcCmd(MFCReg& MFCArgs);
 
 	bool CheckEvents();
 
+	// wait until test() succeeds, pushing to or popping from the channel on another thread wakes this thread
+	template<size_t max_count, typename T> bool WaitChannel(Channel<max_count>& channel, T test);
+
 	u32 GetChannelCount(u32 ch);
 
 	void WriteChannel(u32 ch, const u128& r);
@@ -503,11 +553,11 @@ public:
 	u64  ReadLS64 (const u32 lsa) const { return vm::read64 (lsa + m_offset); }
 	u128 ReadLS128(const u32 lsa) const { return vm::read128(lsa + m_offset); }
 
-	void WriteLS8  (const u32 lsa, const u8&   data) const { vm::write8  (lsa + m_offset, data); }
-	void WriteLS16 (const u32 lsa, const u16&  data) const { vm::write16 (lsa + m_offset, data); }
-	void WriteLS32 (const u32 lsa, const u32&  data) const { vm::write32 (lsa + m_offset, data); }
-	void WriteLS64 (const u32 lsa, const u64&  data) const { vm::write64 (lsa + m_offset, data); }
-	void WriteLS128(const u32 lsa, const u128& data) const { vm::write128(lsa + m_offset, data); }
+	void WriteLS8  (const u32 lsa, const u8&   data) { vm::write8  (lsa + m_offset, data); MarkLSDirty(lsa, 1); }
+	void WriteLS16 (const u32 lsa, const u16&  data) { vm::write16 (lsa + m_offset, data); MarkLSDirty(lsa, 2); }
+	void WriteLS32 (const u32 lsa, const u32&  data) { vm::write32 (lsa + m_offset, data); MarkLSDirty(lsa, 4); }
+	void WriteLS64 (const u32 lsa, const u64&  data) { vm::write64 (lsa + m_offset, data); MarkLSDirty(lsa, 8); }
+	void WriteLS128(const u32 lsa, const u128& data) { vm::write128(lsa + m_offset, data); MarkLSDirty(lsa, 16); }
 
 	std::function<void(SPUThread& SPU)> m_custom_task;
 	std::function<u64(SPUThread& SPU)> m_code3_func;
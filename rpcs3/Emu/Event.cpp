@@ -80,6 +80,6 @@ bool EventManager::SendEvent(u64 key, u64 source, u64 d1, u64 d2, u64 d3)
 		return false;
 	}
 	
-	f->second->events.push(source, d1, d2, d3);
+	f->second->push(source, d1, d2, d3);
 	return true;
 }
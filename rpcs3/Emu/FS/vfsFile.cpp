@@ -67,6 +67,16 @@ u64 vfsFile::Read(void* dst, u64 size)
 	return m_stream->Read(dst, size);
 }
 
+u64 vfsFile::WriteAt(u64 offset, const void* src, u64 size)
+{
+	return m_stream->WriteAt(offset, src, size);
+}
+
+u64 vfsFile::ReadAt(u64 offset, void* dst, u64 size)
+{
+	return m_stream->ReadAt(offset, dst, size);
+}
+
 u64 vfsFile::Seek(s64 offset, vfsSeekMode mode)
 {
 	return m_stream->Seek(offset, mode);
@@ -16,18 +16,6 @@ static const rFile::OpenMode vfs2wx_mode(vfsOpenMode mode)
 	return rFile::read;
 }
 
-static const rSeekMode vfs2wx_seek(vfsSeekMode mode)
-{
-	switch(mode)
-	{
-	case vfsSeekSet: return rFromStart;
-	case vfsSeekCur: return rFromCurrent;
-	case vfsSeekEnd: return rFromEnd;
-	}
-
-	return rFromStart;
-}
-
 vfsLocalFile::vfsLocalFile(vfsDevice* device) : vfsFileBase(device)
 {
 }
@@ -96,24 +84,45 @@ u64 vfsLocalFile::GetSize()
 	return m_file.Length();
 }
 
+// the stream position is kept in m_pos and every access is positional, so the OS file pointer is never used
+// (it's moved by positional I/O on Windows, which would break concurrent AIO requests)
 u64 vfsLocalFile::Write(const void* src, u64 size)
 {
-	return m_file.Write(src, size);
+	if (m_mode & vfsAppend)
+	{
+		m_pos = m_file.Length();
+	}
+
+	const u64 res = m_file.WriteAt(src, size, m_pos);
+	m_pos += res;
+	return res;
 }
 
 u64 vfsLocalFile::Read(void* dst, u64 size)
 {
-	return m_file.Read(dst, size);
+	const u64 res = m_file.ReadAt(dst, size, m_pos);
+	m_pos += res;
+	return res;
+}
+
+u64 vfsLocalFile::WriteAt(u64 offset, const void* src, u64 size)
+{
+	return m_file.WriteAt(src, size, offset);
+}
+
+u64 vfsLocalFile::ReadAt(u64 offset, void* dst, u64 size)
+{
+	return m_file.ReadAt(dst, size, offset);
 }
 
 u64 vfsLocalFile::Seek(s64 offset, vfsSeekMode mode)
 {
-	return m_file.Seek(offset, vfs2wx_seek(mode));
+	return vfsStream::Seek(offset, mode);
 }
 
 u64 vfsLocalFile::Tell() const
 {
-	return m_file.Tell();
+	return vfsStream::Tell();
 }
 
 bool vfsLocalFile::IsOpened() const
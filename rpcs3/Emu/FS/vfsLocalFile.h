@@ -20,6 +20,9 @@ public:
 	virtual u64 Write(const void* src, u64 size) override;
 	virtual u64 Read(void* dst, u64 size) override;
 
+	virtual u64 WriteAt(u64 offset, const void* src, u64 size) override;
+	virtual u64 ReadAt(u64 offset, void* dst, u64 size) override;
+
 	virtual u64 Seek(s64 offset, vfsSeekMode mode = vfsSeekSet) override;
 	virtual u64 Tell() const override;
 
@@ -46,6 +46,26 @@ u64 vfsStream::Read(void* dst, u64 size)
 	return size;
 }
 
+u64 vfsStream::WriteAt(u64 offset, const void* src, u64 size)
+{
+	const u64 old_pos = Tell();
+	Seek(offset);
+	const u64 res = Write(src, size);
+	Seek(old_pos);
+
+	return res;
+}
+
+u64 vfsStream::ReadAt(u64 offset, void* dst, u64 size)
+{
+	const u64 old_pos = Tell();
+	Seek(offset);
+	const u64 res = Read(dst, size);
+	Seek(old_pos);
+
+	return res;
+}
+
 u64 vfsStream::Seek(s64 offset, vfsSeekMode mode)
 {
 	switch(mode)
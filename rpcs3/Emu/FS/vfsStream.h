@@ -25,6 +25,11 @@ public:
 	virtual u64 Write(const void* src, u64 size);
 	virtual u64 Read(void* dst, u64 size);
 
+	// read or write at the specified offset without moving the stream position
+	// (the default implementation seeks, so it's only safe if the stream isn't used concurrently)
+	virtual u64 WriteAt(u64 offset, const void* src, u64 size);
+	virtual u64 ReadAt(u64 offset, void* dst, u64 size);
+
 	virtual u64 Seek(s64 offset, vfsSeekMode mode = vfsSeekSet);
 	virtual u64 Tell() const;
 	virtual bool Eof();
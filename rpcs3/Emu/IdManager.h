@@ -115,44 +115,150 @@ public:
 	}
 };
 
+// ids are slot indices combined with a generation counter, so the lookup doesn't need a map or a lock:
+// readers only announce themselves in the slot, and RemoveID waits for them before the entry is destroyed
 class IdManager
 {
-	static const u32 s_first_id = 1;
-	static const u32 s_max_id = -1;
+	static const u32 s_index_bits = 20;
+	static const u32 s_index_mask = (1 << s_index_bits) - 1;
+	static const u32 s_gen_bits = 11;
+	static const u32 s_gen_mask = (1 << s_gen_bits) - 1; // bit 31 is never set, so no valid id is equal to rID_ANY
+	static const u32 s_page_size = 0x1000;
+	static const u32 s_page_count = (s_index_mask + 1) / s_page_size;
+
+	struct IDEntry
+	{
+		const u32 id;
+		ID info;
 
-	std::unordered_map<u32, ID> m_id_map;
+		IDEntry(const u32 id, ID&& info)
+			: id(id)
+			, info(std::move(info))
+		{
+		}
+	};
+
+	struct IDSlot
+	{
+		std::atomic<IDEntry*> entry;
+		std::atomic<u32> readers; // threads currently accessing the entry
+		u32 gen; // protected by m_mtx_main
+		u8 pad[64 - sizeof(std::atomic<IDEntry*>) - 2 * sizeof(u32)]; // avoid sharing cache lines between slots
+
+		IDSlot()
+			: entry(nullptr)
+			, readers(0)
+			, gen(0)
+		{
+		}
+	};
+
+	std::atomic<IDSlot*> m_pages[s_page_count]; // allocated on demand, freed only in destructor
+	std::atomic<u32> m_count;
+	std::vector<u32> m_free; // released slot indices
 	std::set<u32> m_types[TYPE_OTHER];
-	std::mutex m_mtx_main;
+	std::mutex m_mtx_main; // protects everything except the lookup
+
+	u32 m_next_index;
+
+	IDSlot* GetSlot(const u32 index) const
+	{
+		IDSlot* page = m_pages[index / s_page_size].load(std::memory_order_acquire);
+
+		return page ? &page[index % s_page_size] : nullptr;
+	}
+
+	// call func(const ID&) for the entry while it can't be destroyed; doesn't block
+	template<typename F>
+	bool AccessID(const u32 id, F func)
+	{
+		if (id >> (s_index_bits + s_gen_bits)) {
+			return false;
+		}
+
+		IDSlot* slot = GetSlot(id & s_index_mask);
 
-	u32 m_cur_id;
+		if (!slot) {
+			return false;
+		}
+
+		slot->readers++;
+
+		// seq_cst ordering pairs with the store in RemoveID: either the entry is still seen here,
+		// or RemoveID sees the reader and waits for it
+		IDEntry* entry = slot->entry.load();
+		const bool result = entry && entry->id == id && func(entry->info);
+
+		slot->readers--;
+
+		return result;
+	}
+
+	static void ReleaseEntry(IDSlot& slot)
+	{
+		IDEntry* entry = slot.entry.exchange(nullptr);
+
+		while (slot.readers.load()) {
+			std::this_thread::yield();
+		}
+
+		if (entry) {
+			entry->info.Kill();
+			delete entry;
+		}
+
+		slot.gen = (slot.gen + 1) & s_gen_mask;
+	}
 
 public:
-	IdManager() : m_cur_id(s_first_id)
+	IdManager()
+		: m_count(0)
+		, m_next_index(1)
 	{
+		for (auto& page : m_pages) {
+			page.store(nullptr, std::memory_order_relaxed);
+		}
 	}
 	
 	~IdManager()
 	{
 		Clear();
+
+		for (auto& page : m_pages) {
+			delete[] page.exchange(nullptr);
+		}
 	}
 
 	bool CheckID(const u32 id)
 	{
-		std::lock_guard<std::mutex> lock(m_mtx_main);
+		return AccessID(id, [](const ID&) { return true; });
+	}
 
-		return m_id_map.find(id) != m_id_map.end();
+	// check that the id exists and was created by the specified module
+	bool CheckID(const u32 id, const std::string& name)
+	{
+		return AccessID(id, [&](const ID& info) { return info.GetName() == name; });
 	}
 
 	void Clear()
 	{
 		std::lock_guard<std::mutex> lock(m_mtx_main);
 
-		for(auto& i : m_id_map) {
-			i.second.Kill();
+		for (u32 index = 1; index < m_next_index; index++) {
+			if (IDSlot* slot = GetSlot(index)) {
+				if (slot->entry.load()) {
+					ReleaseEntry(*slot);
+				}
+			}
 		}
 
-		m_id_map.clear();
-		m_cur_id = s_first_id;
+		for (auto& type : m_types) {
+			type.clear();
+		}
+
+		m_free.clear();
+		m_count = 0;
+		m_next_index = 1;
 	}
 	
 	template<typename T 
@@ -164,45 +270,73 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(m_mtx_main);
 
-		m_id_map[m_cur_id] = ID(name, data, type);
+		u32 index;
+
+		if (m_free.size()) {
+			index = m_free.back();
+			m_free.pop_back();
+		}
+		else {
+			assert(m_next_index <= s_index_mask && "Too many IDs");
+			index = m_next_index++;
+		}
+
+		IDSlot* slot = GetSlot(index);
+
+		if (!slot) {
+			IDSlot* page = new IDSlot[s_page_size];
+			m_pages[index / s_page_size].store(page, std::memory_order_release);
+			slot = &page[index % s_page_size];
+		}
+
+		const u32 id = slot->gen << s_index_bits | index;
+
+		slot->entry.store(new IDEntry(id, ID(name, data, type)), std::memory_order_release);
+		m_count++;
+
 		if (type < TYPE_OTHER) {
-			m_types[type].insert(m_cur_id);
+			m_types[type].insert(id);
 		}
 
-		return m_cur_id++;
+		return id;
 	}
-	
-	ID& GetID(const u32 id)
-	{
-		std::lock_guard<std::mutex> lock(m_mtx_main);
 
-		return m_id_map[id];
+	template<typename T>
+	bool GetIDData(const u32 id, std::shared_ptr<T>& result)
+	{
+		return AccessID(id, [&](const ID& info)
+		{
+			result = info.GetData()->get<T>();
+			return true;
+		});
 	}
 
+	// same as above, but only succeeds if the id was created by the specified module (optionally returns the type too)
 	template<typename T>
-	bool GetIDData(const u32 id, std::shared_ptr<T>& result)
+	bool GetIDData(const u32 id, std::shared_ptr<T>& result, const std::string& name, IDType* type = nullptr)
 	{
-		std::lock_guard<std::mutex> lock(m_mtx_main);
+		return AccessID(id, [&](const ID& info) -> bool
+		{
+			if (info.GetName() != name) {
+				return false;
+			}
 
-		auto f = m_id_map.find(id);
-		if (f == m_id_map.end()) {
-			return false;
-		}
+			result = info.GetData()->get<T>();
 
-		result = f->second.GetData()->get<T>();
+			if (type) {
+				*type = info.GetType();
+			}
 
-		return true;
+			return true;
+		});
 	}
 
 	bool HasID(const u32 id)
 	{
-		{
-			std::lock_guard<std::mutex> lock(m_mtx_main);
-
-			if(id == rID_ANY) {
-				return m_id_map.begin() != m_id_map.end();
-			}
+		if (id == rID_ANY) {
+			return m_count.load() != 0;
 		}
+
 		return CheckID(id);
 	}
 
@@ -210,17 +344,20 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(m_mtx_main);
 
-		auto item = m_id_map.find(id);
+		IDSlot* slot = id >> (s_index_bits + s_gen_bits) ? nullptr : GetSlot(id & s_index_mask);
+		IDEntry* entry = slot ? slot->entry.load() : nullptr;
 
-		if (item == m_id_map.end()) {
+		if (!entry || entry->id != id) {
 			return false;
 		}
-		if (item->second.GetType() < TYPE_OTHER) {
-			m_types[item->second.GetType()].erase(id);
+
+		if (entry->info.GetType() < TYPE_OTHER) {
+			m_types[entry->info.GetType()].erase(id);
 		}
 
-		item->second.Kill();
-		m_id_map.erase(item);
+		ReleaseEntry(*slot);
+		m_free.push_back(id & s_index_mask);
+		m_count--;
 
 		return true;
 	}
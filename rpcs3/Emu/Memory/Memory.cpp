@@ -349,22 +349,16 @@ bool MemoryBlock::IsMyAddress(const u64 addr)
 
 DynamicMemoryBlockBase::DynamicMemoryBlockBase()
 	: MemoryBlock()
+	, m_used(0)
 	, m_max_size(0)
 {
 }
 
 const u32 DynamicMemoryBlockBase::GetUsedSize() const
 {
-	LV2_LOCK(0);
-
-	u32 size = 0;
+	std::lock_guard<std::mutex> lock(m_lock);
 
-	for (u32 i = 0; i<m_allocated.size(); ++i)
-	{
-		size += m_allocated[i].size;
-	}
-
-	return size;
+	return m_used;
 }
 
 bool DynamicMemoryBlockBase::IsInMyRange(const u64 addr)
@@ -384,7 +378,7 @@ bool DynamicMemoryBlockBase::IsMyAddress(const u64 addr)
 
 MemoryBlock* DynamicMemoryBlockBase::SetRange(const u64 start, const u32 size)
 {
-	LV2_LOCK(0);
+	std::lock_guard<std::mutex> lock(m_lock);
 
 	m_max_size = PAGE_4K(size);
 	if (!MemoryBlock::SetRange(start, 0))
@@ -393,19 +387,93 @@ MemoryBlock* DynamicMemoryBlockBase::SetRange(const u64 start, const u32 size)
 		return nullptr;
 	}
 
+	m_free.clear();
+	m_free_by_size.clear();
+	m_used = 0;
+
+	if (m_max_size)
+	{
+		m_free[start] = m_max_size;
+		m_free_by_size.emplace(m_max_size, start);
+	}
+
 	return this;
 }
 
 void DynamicMemoryBlockBase::Delete()
 {
-	LV2_LOCK(0);
+	std::map<u64, MemBlockInfo> allocated;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
 
-	m_allocated.clear();
-	m_max_size = 0;
+		allocated.swap(m_allocated);
+		m_free.clear();
+		m_free_by_size.clear();
+		m_used = 0;
+		m_max_size = 0;
+	}
+
+	// blocks are decommitted without holding the lock (it takes the LV2 mutex)
+	allocated.clear();
 
 	MemoryBlock::Delete();
 }
 
+void DynamicMemoryBlockBase::ReserveExtent(std::map<u64, u32>::iterator extent, u64 addr, u32 size) /* private */
+{
+	const u64 ext_addr = extent->first;
+	const u32 ext_size = extent->second;
+
+	m_free_by_size.erase(std::make_pair(ext_size, ext_addr));
+	m_free.erase(extent);
+
+	// put back the unused parts
+	if (addr > ext_addr)
+	{
+		m_free[ext_addr] = (u32)(addr - ext_addr);
+		m_free_by_size.emplace((u32)(addr - ext_addr), ext_addr);
+	}
+
+	if (addr + size < ext_addr + ext_size)
+	{
+		const u32 rest = (u32)(ext_addr + ext_size - addr - size);
+		m_free[addr + size] = rest;
+		m_free_by_size.emplace(rest, addr + size);
+	}
+
+	m_used += size;
+}
+
+void DynamicMemoryBlockBase::ReleaseExtent(u64 addr, u32 size) /* private */
+{
+	auto next = m_free.lower_bound(addr);
+
+	// merge with the following extent
+	if (next != m_free.end() && next->first == addr + size)
+	{
+		size += next->second;
+		m_free_by_size.erase(std::make_pair(next->second, next->first));
+		next = m_free.erase(next);
+	}
+
+	// merge with the preceding extent
+	if (next != m_free.begin())
+	{
+		auto prev = std::prev(next);
+
+		if (prev->first + prev->second == addr)
+		{
+			m_free_by_size.erase(std::make_pair(prev->second, prev->first));
+			addr = prev->first;
+			size += prev->second;
+			m_free.erase(prev);
+		}
+	}
+
+	m_free[addr] = size;
+	m_free_by_size.emplace(size, addr);
+}
+
 bool DynamicMemoryBlockBase::AllocFixed(u64 addr, u32 size)
 {
 	size = PAGE_4K(size + (addr & 4095)); // align size
@@ -418,11 +486,25 @@ bool DynamicMemoryBlockBase::AllocFixed(u64 addr, u32 size)
 		return false;
 	}
 
-	LV2_LOCK(0);
-
-	for (u32 i = 0; i<m_allocated.size(); ++i)
 	{
-		if (addr >= m_allocated[i].addr && addr < m_allocated[i].addr + m_allocated[i].size) return false;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		// find the free extent containing the address
+		auto extent = m_free.upper_bound(addr);
+
+		if (extent == m_free.begin())
+		{
+			return false;
+		}
+
+		--extent;
+
+		if (extent->first + extent->second < addr + size)
+		{
+			return false;
+		}
+
+		ReserveExtent(extent, addr, size);
 	}
 
 	AppendMem(addr, size);
@@ -432,7 +514,12 @@ bool DynamicMemoryBlockBase::AllocFixed(u64 addr, u32 size)
 
 void DynamicMemoryBlockBase::AppendMem(u64 addr, u32 size) /* private */
 {
-	m_allocated.emplace_back(addr, size);
+	// the memory is committed outside of the lock, the extent is already reserved
+	MemBlockInfo info(addr, size);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_allocated.emplace(addr, std::move(info));
 }
 
 u64 DynamicMemoryBlockBase::AllocAlign(u32 size, u32 align)
@@ -454,41 +541,47 @@ u64 DynamicMemoryBlockBase::AllocAlign(u32 size, u32 align)
 	else
 	{
 		align &= ~4095;
-		exsize = size + align - 1;
+		exsize = size + align - 4096;
 	}
 
-	LV2_LOCK(0);
+	if (!size || exsize < size)
+	{
+		return 0;
+	}
 
-	for (u64 addr = MemoryBlock::GetStartAddr(); addr <= MemoryBlock::GetEndAddr() - exsize;)
+	u64 addr;
 	{
-		bool is_good_addr = true;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		// best fit: the smallest extent of sufficient size (the lowest address if there are several)
+		auto found = m_free_by_size.lower_bound(std::make_pair(size, (u64)0));
 
-		for (u32 i = 0; i<m_allocated.size(); ++i)
+		if (found != m_free_by_size.end() && align && ((found->second + (align - 1)) & ~(u64)(align - 1)) + size > found->second + found->first)
 		{
-			if ((addr >= m_allocated[i].addr && addr < m_allocated[i].addr + m_allocated[i].size) ||
-				(m_allocated[i].addr >= addr && m_allocated[i].addr < addr + exsize))
-			{
-				is_good_addr = false;
-				addr = m_allocated[i].addr + m_allocated[i].size;
-				break;
-			}
+			// alignment doesn't fit, take an extent which fits with any alignment
+			found = m_free_by_size.lower_bound(std::make_pair(exsize, (u64)0));
 		}
 
-		if (!is_good_addr) continue;
+		if (found == m_free_by_size.end())
+		{
+			return 0;
+		}
+
+		addr = found->second;
 
 		if (align)
 		{
-			addr = (addr + (align - 1)) & ~(align - 1);
+			addr = (addr + (align - 1)) & ~(u64)(align - 1);
 		}
 
-		//LOG_NOTICE(MEMORY, "AllocAlign(size=0x%x) -> 0x%llx", size, addr);
+		ReserveExtent(m_free.find(found->second), addr, size);
+	}
 
-		AppendMem(addr, size);
+	//LOG_NOTICE(MEMORY, "AllocAlign(size=0x%x) -> 0x%llx", size, addr);
 
-		return addr;
-	}
+	AppendMem(addr, size);
 
-	return 0;
+	return addr;
 }
 
 bool DynamicMemoryBlockBase::Alloc()
@@ -498,23 +591,32 @@ bool DynamicMemoryBlockBase::Alloc()
 
 bool DynamicMemoryBlockBase::Free(u64 addr)
 {
-	LV2_LOCK(0);
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	auto found = m_allocated.find(addr);
 
-	for (u32 num = 0; num < m_allocated.size(); num++)
+	if (found != m_allocated.end())
 	{
-		if (addr == m_allocated[num].addr)
-		{
-			//LOG_NOTICE(MEMORY, "Free(0x%llx)", addr);
+		//LOG_NOTICE(MEMORY, "Free(0x%llx)", addr);
 
-			m_allocated.erase(m_allocated.begin() + num);
-			return true;
-		}
+		MemBlockInfo info(std::move(found->second));
+		m_allocated.erase(found);
+
+		// decommit before the extent can be reused
+		lock.unlock();
+		info.Free();
+		info.mem = nullptr;
+		lock.lock();
+
+		ReleaseExtent(info.addr, info.size);
+		m_used -= info.size;
+		return true;
 	}
 
 	LOG_ERROR(MEMORY, "DynamicMemoryBlock::Free(addr=0x%llx): failed", addr);
-	for (u32 i = 0; i < m_allocated.size(); i++)
+	for (auto& block : m_allocated)
 	{
-		LOG_NOTICE(MEMORY, "*** Memory Block: addr = 0x%llx, size = 0x%x", m_allocated[i].addr, m_allocated[i].size);
+		LOG_NOTICE(MEMORY, "*** Memory Block: addr = 0x%llx, size = 0x%x", block.second.addr, block.second.size);
 	}
 	return false;
 }
@@ -547,6 +649,39 @@ bool DynamicMemoryBlockBase::Unlock(u64 addr, u32 size)
 
 VirtualMemoryBlock::VirtualMemoryBlock() : MemoryBlock(), m_reserve_size(0)
 {
+	for (auto& page : m_page_table)
+	{
+		page.store(page_unmapped, std::memory_order_relaxed);
+	}
+}
+
+void VirtualMemoryBlock::UpdatePages(u64 addr, u32 size) /* private */
+{
+	// must be called after m_mapped_memory is modified, pages are rebuilt from it in the order used by getRealAddrSlow()
+	for (u64 page = addr >> page_shift; page < 0x1000 && page < (addr + size + page_mask) >> page_shift; page++)
+	{
+		const u64 start = page << page_shift;
+		u32 value = page_unmapped;
+
+		for (u32 i = 0; i<m_mapped_memory.size(); ++i)
+		{
+			const VirtualMemInfo& info = m_mapped_memory[i];
+
+			if (info.addr < start + page_mask + 1 && start < info.addr + info.size)
+			{
+				// the first overlapping mapping translates the whole page only if it covers it and keeps the alignment
+				if (info.addr <= start && start + page_mask + 1 <= info.addr + info.size && !((info.addr ^ info.realAddress) & page_mask) &&
+					info.realAddress + (start - info.addr) < 0x100000000ull)
+				{
+					value = (u32)(info.realAddress + (start - info.addr));
+				}
+
+				break;
+			}
+		}
+
+		m_page_table[page].store(value, std::memory_order_relaxed);
+	}
 }
 
 MemoryBlock* VirtualMemoryBlock::SetRange(const u64 start, const u32 size)
@@ -601,6 +736,7 @@ u64 VirtualMemoryBlock::Map(u64 realaddr, u32 size)
 		if (!is_good_addr) continue;
 
 		m_mapped_memory.emplace_back(addr, realaddr, size);
+		UpdatePages(addr, size);
 
 		return addr;
 	}
@@ -614,6 +750,7 @@ bool VirtualMemoryBlock::Map(u64 realaddr, u32 size, u64 addr)
 		return false;
 
 	m_mapped_memory.emplace_back(addr, realaddr, size);
+	UpdatePages(addr, size);
 	return true;
 }
 
@@ -623,8 +760,10 @@ bool VirtualMemoryBlock::UnmapRealAddress(u64 realaddr, u32& size)
 	{
 		if (m_mapped_memory[i].realAddress == realaddr && IsInMyRange(m_mapped_memory[i].addr, m_mapped_memory[i].size))
 		{
+			const u64 addr = m_mapped_memory[i].addr;
 			size = m_mapped_memory[i].size;
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
+			UpdatePages(addr, size);
 			return true;
 		}
 	}
@@ -640,6 +779,7 @@ bool VirtualMemoryBlock::UnmapAddress(u64 addr, u32& size)
 		{
 			size = m_mapped_memory[i].size;
 			m_mapped_memory.erase(m_mapped_memory.begin() + i);
+			UpdatePages(addr, size);
 			return true;
 		}
 	}
@@ -665,7 +805,7 @@ bool VirtualMemoryBlock::Write32(const u64 addr, const u32 value)
 	return true;
 }
 
-bool VirtualMemoryBlock::getRealAddr(u64 addr, u64& result)
+bool VirtualMemoryBlock::getRealAddrSlow(u64 addr, u64& result) /* private */
 {
 	for (u32 i = 0; i<m_mapped_memory.size(); ++i)
 	{
@@ -696,6 +836,11 @@ void VirtualMemoryBlock::Delete()
 {
 	m_mapped_memory.clear();
 
+	for (auto& page : m_page_table)
+	{
+		page.store(page_unmapped, std::memory_order_relaxed);
+	}
+
 	MemoryBlock::Delete();
 }
 
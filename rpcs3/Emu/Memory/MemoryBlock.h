@@ -1,4 +1,5 @@
 #pragma once
+#include <map>
 
 #define PAGE_4K(x) (x + 4095) & ~(4095)
 
@@ -116,7 +117,11 @@ public:
 
 class DynamicMemoryBlockBase : public MemoryBlock
 {
-	std::vector<MemBlockInfo> m_allocated; // allocation info
+	mutable std::mutex m_lock; // protects the allocation info (the LV2 mutex isn't used)
+	std::map<u64, MemBlockInfo> m_allocated; // committed blocks by address
+	std::map<u64, u32> m_free; // free extents by address (neighbours are always merged)
+	std::set<std::pair<u32, u64>> m_free_by_size; // the same extents by (size, address)
+	u32 m_used; // size of the reserved extents
 	u32 m_max_size;
 
 public:
@@ -145,6 +150,10 @@ public:
 
 private:
 	void AppendMem(u64 addr, u32 size);
+
+	// must be called under m_lock
+	void ReserveExtent(std::map<u64, u32>::iterator extent, u64 addr, u32 size);
+	void ReleaseExtent(u64 addr, u32 size);
 };
 
 class VirtualMemoryBlock : public MemoryBlock
@@ -152,6 +161,17 @@ class VirtualMemoryBlock : public MemoryBlock
 	std::vector<VirtualMemInfo> m_mapped_memory;
 	u32 m_reserve_size;
 
+	// real address of each mapped 1 MB page of the 32 bit address space (only pages entirely translated by one mapping
+	// aligned to 1 MB are added, other addresses are looked up in m_mapped_memory)
+	std::atomic<u32> m_page_table[0x1000];
+
+	static const u32 page_shift = 20;
+	static const u32 page_mask = (1 << page_shift) - 1;
+	static const u32 page_unmapped = ~0u;
+
+	void UpdatePages(u64 addr, u32 size);
+	bool getRealAddrSlow(u64 addr, u64& result);
+
 public:
 	VirtualMemoryBlock();
 
@@ -187,7 +207,18 @@ public:
 
 	// try to get the real address given a mapped address
 	// return true for success
-	bool getRealAddr(u64 addr, u64& result);
+	bool getRealAddr(u64 addr, u64& result)
+	{
+		const u32 page = addr >> page_shift < 0x1000 ? m_page_table[addr >> page_shift].load(std::memory_order_relaxed) : page_unmapped;
+
+		if (page != page_unmapped)
+		{
+			result = page | (addr & page_mask);
+			return true;
+		}
+
+		return getRealAddrSlow(addr, result);
+	}
 
 	u64 RealAddr(u64 addr)
 	{
@@ -0,0 +1,112 @@
+#include "stdafx.h"
+#include "Memory.h"
+#include "vm_reservation.h"
+
+namespace vm
+{
+	const u32 g_reservation_table_size = 0x10000; // 8 MB of lines before stamps are shared
+
+	std::atomic<u64> g_reservation_stamps[g_reservation_table_size];
+
+	// threads waiting for reservation loss, hashed by line address (each bucket has its own lock)
+	struct reservation_waiters_t
+	{
+		std::mutex mutex;
+		std::vector<std::pair<NamedThreadBase*, u32>> threads; // (thread, line address)
+		std::atomic<u32> count;
+	};
+
+	const u32 g_reservation_waiters_size = 0x100;
+
+	reservation_waiters_t g_reservation_waiters[g_reservation_waiters_size];
+
+	reservation_waiters_t& reservation_waiters(u32 addr)
+	{
+		return g_reservation_waiters[(addr >> 7) % g_reservation_waiters_size];
+	}
+
+	std::atomic<u64>& reservation_stamp(u32 addr)
+	{
+		return g_reservation_stamps[(addr >> 7) % g_reservation_table_size];
+	}
+
+	u64 reservation_acquire(void* data, u32 addr, u32 size)
+	{
+		std::atomic<u64>& line = reservation_stamp(addr);
+
+		while (true)
+		{
+			const u64 stamp = line.load(std::memory_order_acquire);
+
+			if (!(stamp & 1))
+			{
+				memcpy(data, get_ptr<void>(addr), size);
+
+				// the data is consistent if the line wasn't locked in the meantime
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (line.load(std::memory_order_relaxed) == stamp)
+				{
+					return stamp;
+				}
+			}
+
+			_mm_pause();
+		}
+	}
+
+	bool reservation_test(u32 addr, u64 stamp)
+	{
+		// the line may be locked by an update which fails, so the data must be compared in this case
+		return (reservation_stamp(addr).load(std::memory_order_acquire) & ~1ull) == stamp;
+	}
+
+	void reservation_notify(u32 addr)
+	{
+		const u32 line_addr = addr & ~0x7f;
+		reservation_waiters_t& waiters = reservation_waiters(line_addr);
+
+		// pairs with the increment in reservation_add_waiter(), so the waiter either sees the new stamp or gets the signal
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (!waiters.count.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+
+		for (auto& waiter : waiters.threads)
+		{
+			if (waiter.second == line_addr)
+			{
+				waiter.first->Notify();
+			}
+		}
+	}
+
+	void reservation_add_waiter(NamedThreadBase* thread, u32 addr)
+	{
+		reservation_waiters_t& waiters = reservation_waiters(addr);
+
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+
+		waiters.threads.push_back(std::make_pair(thread, addr & ~0x7f));
+		waiters.count++;
+	}
+
+	void reservation_remove_waiter(NamedThreadBase* thread, u32 addr)
+	{
+		reservation_waiters_t& waiters = reservation_waiters(addr);
+
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+
+		auto found = std::find(waiters.threads.begin(), waiters.threads.end(), std::make_pair(thread, addr & ~0x7f));
+
+		if (found != waiters.threads.end())
+		{
+			waiters.threads.erase(found);
+			waiters.count--;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Utilities/Thread.h"
+
+namespace vm
+{
+	// Lock line reservations shared by PPU (lwarx/stwcx) and SPU (GETLLAR/PUTLLC/PUTLLUC).
+	// Each 128 byte line maps to a stamp (lines with the same hash share it), which is odd while the line is being written
+	// and increased by every update. Plain stores don't change the stamps, so conditional updates still compare the data.
+
+	std::atomic<u64>& reservation_stamp(u32 addr);
+
+	// read size bytes (within one line) consistently, returns the stamp
+	u64 reservation_acquire(void* data, u32 addr, u32 size);
+
+	// returns false if the line was updated since reservation_acquire() returned the stamp
+	bool reservation_test(u32 addr, u64 stamp);
+
+	// wake threads waiting for reservation loss on the line (see reservation_add_waiter())
+	void reservation_notify(u32 addr);
+
+	void reservation_add_waiter(NamedThreadBase* thread, u32 addr);
+	void reservation_remove_waiter(NamedThreadBase* thread, u32 addr);
+
+	// lock the line if the stamp is unchanged and call func(), which returns true if it has written the data
+	template<typename F> bool reservation_update(u32 addr, u64 stamp, F func)
+	{
+		std::atomic<u64>& line = reservation_stamp(addr);
+
+		if ((stamp & 1) || !line.compare_exchange_strong(stamp, stamp + 1))
+		{
+			return false;
+		}
+
+		if (!func())
+		{
+			// nothing written, readers don't have to retry
+			line.store(stamp, std::memory_order_release);
+			return false;
+		}
+
+		line.store(stamp + 2, std::memory_order_release);
+		reservation_notify(addr);
+		return true;
+	}
+
+	// lock the line unconditionally and call func(), which writes the data
+	template<typename F> void reservation_store(u32 addr, F func)
+	{
+		std::atomic<u64>& line = reservation_stamp(addr);
+
+		while (true)
+		{
+			u64 stamp = line.load(std::memory_order_relaxed);
+
+			if (!(stamp & 1) && line.compare_exchange_weak(stamp, stamp + 1))
+			{
+				func();
+				line.store(stamp + 2, std::memory_order_release);
+				break;
+			}
+
+			_mm_pause();
+		}
+
+		reservation_notify(addr);
+	}
+}
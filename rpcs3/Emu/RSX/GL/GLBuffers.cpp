@@ -64,6 +64,11 @@ void GLBufferObject::SetData(const void* data, u32 size, u32 usage)
 	SetData(m_type, data, size, usage);
 }
 
+void GLBufferObject::SetSubData(const void* data, u32 offset, u32 size)
+{
+	glBufferSubData(m_type, offset, size, data);
+}
+
 void GLBufferObject::SetAttribPointer(int location, int size, int type, GLvoid* pointer, int stride, bool normalized)
 {
 	if(location < 0) return;
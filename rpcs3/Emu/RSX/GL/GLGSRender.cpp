@@ -23,7 +23,7 @@ void SetGetGSFrameCallback(GetGSFrameCb value)
 	#define CMD_LOG(...)
 #endif
 
-GLuint g_flip_tex, g_depth_tex, g_pbo[6];
+GLuint g_flip_tex, g_flip_pbo;
 int last_width = 0, last_height = 0, last_depth_format = 0;
 
 GLenum g_last_gl_error = GL_NO_ERROR;
@@ -95,7 +95,78 @@ float GLTexture::GetMaxAniso(int aniso)
 	return 1.0f;
 }
 
-void GLTexture::Init(RSXTexture& tex)
+u32 GLTexture::GetTexelSize(int format)
+{
+	switch (format)
+	{
+	case CELL_GCM_TEXTURE_B8:
+		return 1;
+
+	case CELL_GCM_TEXTURE_A1R5G5B5:
+	case CELL_GCM_TEXTURE_A4R4G4B4:
+	case CELL_GCM_TEXTURE_R5G6B5:
+	case CELL_GCM_TEXTURE_G8B8:
+	case CELL_GCM_TEXTURE_R6G5B5:
+	case CELL_GCM_TEXTURE_X16:
+	case CELL_GCM_TEXTURE_R5G5B5A1:
+	case CELL_GCM_TEXTURE_D1R5G5B5:
+		return 2;
+
+	case CELL_GCM_TEXTURE_A8R8G8B8:
+	case CELL_GCM_TEXTURE_Y16_X16:
+	case CELL_GCM_TEXTURE_X32_FLOAT:
+	case CELL_GCM_TEXTURE_D8R8G8B8:
+	case CELL_GCM_TEXTURE_Y16_X16_FLOAT:
+		return 4;
+
+	case CELL_GCM_TEXTURE_W16_Z16_Y16_X16_FLOAT:
+		return 8;
+
+	case CELL_GCM_TEXTURE_W32_Z32_Y32_X32_FLOAT:
+		return 16;
+
+	default:
+		// compressed and depth formats are uploaded as they are
+		return 0;
+	}
+}
+
+u32 GLTexture::GetDataSize(RSXTexture& tex)
+{
+	const int format = tex.GetFormat() & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
+	const u32 width = tex.GetWidth();
+	const u32 height = tex.GetHeight();
+
+	if (const u32 texel_size = GetTexelSize(format))
+	{
+		return width * height * texel_size;
+	}
+
+	switch (format)
+	{
+	case CELL_GCM_TEXTURE_COMPRESSED_DXT1:
+		return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+
+	case CELL_GCM_TEXTURE_COMPRESSED_DXT23:
+	case CELL_GCM_TEXTURE_COMPRESSED_DXT45:
+		return ((width + 3) / 4) * ((height + 3) / 4) * 16;
+
+	case CELL_GCM_TEXTURE_DEPTH24_D8:
+	case CELL_GCM_TEXTURE_DEPTH24_D8_FLOAT:
+		return width * height * 4;
+
+	case CELL_GCM_TEXTURE_DEPTH16:
+	case CELL_GCM_TEXTURE_DEPTH16_FLOAT:
+	case CELL_GCM_TEXTURE_COMPRESSED_B8R8_G8R8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN):
+	case CELL_GCM_TEXTURE_COMPRESSED_R8B8_R8G8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN):
+		return width * height * 2;
+
+	default:
+		return 0;
+	}
+}
+
+void GLTexture::Init(RSXTexture& tex, RSXTextureConverter& converter)
 {
 	if (tex.GetLocation() > 1)
 	{
@@ -119,12 +190,19 @@ void GLTexture::Init(RSXTexture& tex)
 	int format = tex.GetFormat() & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
 	bool is_swizzled = !(tex.GetFormat() & CELL_GCM_TEXTURE_LN);
 
-	auto pixels = vm::get_ptr<const u8>(texaddr);
-	u8 *unswizzledPixels;
+	const u8* pixels = vm::get_ptr<const u8>(texaddr);
 	static const GLint glRemapStandard[4] = { GL_ALPHA, GL_RED, GL_GREEN, GL_BLUE };
 	// NOTE: This must be in ARGB order in all forms below.
 	const GLint *glRemap = glRemapStandard;
 
+	if (is_swizzled)
+	{
+		if (const u32 texel_size = GetTexelSize(format))
+		{
+			pixels = converter.Unswizzle(pixels, tex.GetWidth(), tex.GetHeight(), texel_size);
+		}
+	}
+
 	switch (format)
 	{
 	case CELL_GCM_TEXTURE_B8: // One 8-bit fixed-point number
@@ -141,7 +219,6 @@ void GLTexture::Init(RSXTexture& tex)
 		glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_TRUE);
 		checkForGlError("GLTexture::Init() -> glPixelStorei");
 
-		// TODO: texture swizzling
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, pixels);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_A1R5G5B5)");
 
@@ -175,28 +252,7 @@ void GLTexture::Init(RSXTexture& tex)
 
 	case CELL_GCM_TEXTURE_A8R8G8B8:
 	{
-		if (is_swizzled)
-		{
-			u32 *src, *dst;
-			u32 log2width, log2height;
-
-			unswizzledPixels = (u8*)malloc(tex.GetWidth() * tex.GetHeight() * 4);
-			src = (u32*)pixels;
-			dst = (u32*)unswizzledPixels;
-
-			log2width = log(tex.GetWidth()) / log(2);
-			log2height = log(tex.GetHeight()) / log(2);
-
-			for (int i = 0; i < tex.GetHeight(); i++)
-			{
-				for (int j = 0; j < tex.GetWidth(); j++)
-				{
-					dst[(i*tex.GetHeight()) + j] = src[LinearToSwizzleAddress(j, i, 0, log2width, log2height, 0)];
-				}
-			}
-		}
-	
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, is_swizzled ? unswizzledPixels : pixels);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, pixels);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_A8R8G8B8)");
 	}
 	break;
@@ -240,22 +296,10 @@ void GLTexture::Init(RSXTexture& tex)
 
 	case CELL_GCM_TEXTURE_R6G5B5:
 	{
-		// TODO: Probably need to actually unswizzle if is_swizzled.
-		const u32 numPixels = tex.GetWidth() * tex.GetHeight();
-		unswizzledPixels = (u8 *)malloc(numPixels * 4);
-		// TODO: Speed.
-		for (u32 i = 0; i < numPixels; ++i) {
-			u16 c = reinterpret_cast<const be_t<u16> *>(pixels)[i];
-			unswizzledPixels[i * 4 + 0] = Convert6To8((c >> 10) & 0x3F);
-			unswizzledPixels[i * 4 + 1] = Convert5To8((c >> 5) & 0x1F);
-			unswizzledPixels[i * 4 + 2] = Convert5To8((c >> 0) & 0x1F);
-			unswizzledPixels[i * 4 + 3] = 255;
-		}
+		const u8* converted = converter.ConvertR6G5B5(pixels, tex.GetWidth(), tex.GetHeight());
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, unswizzledPixels);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, converted);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_R6G5B5)");
-
-		free(unswizzledPixels);
 	}
 	break;
 
@@ -367,7 +411,6 @@ void GLTexture::Init(RSXTexture& tex)
 		glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_TRUE);
 		checkForGlError("GLTexture::Init() -> glPixelStorei(CELL_GCM_TEXTURE_D1R5G5B5)");
 
-		// TODO: Texture swizzling
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, pixels);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_D1R5G5B5)");
 
@@ -407,51 +450,19 @@ void GLTexture::Init(RSXTexture& tex)
 
 	case CELL_GCM_TEXTURE_COMPRESSED_B8R8_G8R8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN):
 	{
-		const u32 numPixels = tex.GetWidth() * tex.GetHeight();
-		unswizzledPixels = (u8 *)malloc(numPixels * 4);
-		// TODO: Speed.
-		for (u32 i = 0; i < numPixels; i += 2) {
-			unswizzledPixels[i * 4 + 0 + 0] = pixels[i * 2 + 3];
-			unswizzledPixels[i * 4 + 0 + 1] = pixels[i * 2 + 2];
-			unswizzledPixels[i * 4 + 0 + 2] = pixels[i * 2 + 0];
-			unswizzledPixels[i * 4 + 0 + 3] = 255;
-
-			// The second pixel is the same, except for red.
-			unswizzledPixels[i * 4 + 4 + 0] = pixels[i * 2 + 1];
-			unswizzledPixels[i * 4 + 4 + 1] = pixels[i * 2 + 2];
-			unswizzledPixels[i * 4 + 4 + 2] = pixels[i * 2 + 0];
-			unswizzledPixels[i * 4 + 4 + 3] = 255;
-		}
+		const u8* converted = converter.ConvertB8R8_G8R8(pixels, tex.GetWidth(), tex.GetHeight());
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, unswizzledPixels);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, converted);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_COMPRESSED_B8R8_G8R8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN)");
-
-		free(unswizzledPixels);
 	}
 	break;
 
 	case CELL_GCM_TEXTURE_COMPRESSED_R8B8_R8G8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN):
 	{
-		const u32 numPixels = tex.GetWidth() * tex.GetHeight();
-		unswizzledPixels = (u8 *)malloc(numPixels * 4);
-		// TODO: Speed.
-		for (u32 i = 0; i < numPixels; i += 2) {
-			unswizzledPixels[i * 4 + 0 + 0] = pixels[i * 2 + 2];
-			unswizzledPixels[i * 4 + 0 + 1] = pixels[i * 2 + 3];
-			unswizzledPixels[i * 4 + 0 + 2] = pixels[i * 2 + 1];
-			unswizzledPixels[i * 4 + 0 + 3] = 255;
-
-			// The second pixel is the same, except for red.
-			unswizzledPixels[i * 4 + 4 + 0] = pixels[i * 2 + 0];
-			unswizzledPixels[i * 4 + 4 + 1] = pixels[i * 2 + 3];
-			unswizzledPixels[i * 4 + 4 + 2] = pixels[i * 2 + 1];
-			unswizzledPixels[i * 4 + 4 + 3] = 255;
-		}
+		const u8* converted = converter.ConvertR8B8_R8G8(pixels, tex.GetWidth(), tex.GetHeight());
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, unswizzledPixels);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex.GetWidth(), tex.GetHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, converted);
 		checkForGlError("GLTexture::Init() -> glTexImage2D(CELL_GCM_TEXTURE_COMPRESSED_R8B8_R8G8 & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN)");
-
-		free(unswizzledPixels);
 	}
 	break;
 
@@ -485,6 +496,11 @@ void GLTexture::Init(RSXTexture& tex)
 
 	checkForGlError("GLTexture::Init() -> remap");
 
+	SetSamplerState(tex);
+}
+
+void GLTexture::SetSamplerState(RSXTexture& tex)
+{
 	static const int gl_tex_zfunc[] =
 	{
 		GL_NEVER,
@@ -543,13 +559,6 @@ void GLTexture::Init(RSXTexture& tex)
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GetMaxAniso(tex.GetMaxAniso()));
 
 	checkForGlError("GLTexture::Init() -> max anisotropy");
-
-	//Unbind();
-
-	if (is_swizzled && format == CELL_GCM_TEXTURE_A8R8G8B8)
-	{
-		free(unswizzledPixels);
-	}
 }
 
 void GLTexture::Save(RSXTexture& tex, const std::string& name)
@@ -635,6 +644,147 @@ void GLTexture::Delete()
 	}
 }
 
+GLTextureCache::GLTextureCache()
+	: m_frame(0)
+	, m_hits(0)
+	, m_misses(0)
+	, m_uploaded_bytes(0)
+	, m_skipped_bytes(0)
+	, m_frame_uploaded_bytes(0)
+	, m_last_frame_uploaded_bytes(0)
+{
+}
+
+u64 GLTextureCache::Hash(const u8* data, u32 size)
+{
+	// FNV-1a variant processing 8 bytes at once
+	u64 hash = 0xcbf29ce484222325ull ^ size;
+	u32 i = 0;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		hash ^= *(const u64*)(data + i);
+		hash *= 0x100000001b3ull;
+	}
+
+	for (; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+void GLTextureCache::Bind(RSXTexture& tex, RSXTextureConverter& converter)
+{
+	const u32 addr = GetAddress(tex.GetOffset(), tex.GetLocation());
+	const u32 size = GLTexture::GetDataSize(tex);
+
+	// unknown formats and bad addresses are always passed to GLTexture::Init()
+	const bool cacheable = tex.GetLocation() <= 1 && size && Memory.IsGoodAddr(addr, size);
+	const u64 hash = cacheable ? Hash(vm::get_ptr<const u8>(addr), size) : 0;
+
+	auto& list = m_entries[addr];
+	Entry* entry = nullptr;
+
+	for (auto& e : list)
+	{
+		if (e.format == tex.GetFormat() && e.width == tex.GetWidth() && e.height == tex.GetHeight() &&
+			e.pitch == tex.m_pitch && e.remap == tex.GetRemap() && e.mipmap == tex.GetMipmap())
+		{
+			entry = &e;
+			break;
+		}
+	}
+
+	if (!entry)
+	{
+		list.emplace_back();
+		entry = &list.back();
+		entry->addr = addr;
+		entry->format = tex.GetFormat();
+		entry->width = tex.GetWidth();
+		entry->height = tex.GetHeight();
+		entry->pitch = tex.m_pitch;
+		entry->remap = tex.GetRemap();
+		entry->mipmap = tex.GetMipmap();
+		entry->texture.Create();
+	}
+	else
+	{
+		entry->texture.Bind();
+
+		if (cacheable && entry->hash == hash)
+		{
+			entry->texture.SetSamplerState(tex);
+			entry->last_used = m_frame;
+			m_hits++;
+			m_skipped_bytes += size;
+			return;
+		}
+	}
+
+	entry->texture.Init(tex, converter);
+	entry->hash = hash;
+	entry->last_used = m_frame;
+	m_misses++;
+	m_uploaded_bytes += size;
+	m_frame_uploaded_bytes += size;
+}
+
+void GLTextureCache::EndFrame()
+{
+	m_last_frame_uploaded_bytes = m_frame_uploaded_bytes;
+	m_frame_uploaded_bytes = 0;
+
+	if (++m_frame % 60)
+	{
+		return;
+	}
+
+	// delete textures unused for 60 frames
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		auto& list = it->second;
+
+		for (size_t i = 0; i < list.size();)
+		{
+			if (m_frame - list[i].last_used > 60)
+			{
+				list[i].texture.Delete();
+				list.erase(list.begin() + i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		it = list.empty() ? m_entries.erase(it) : std::next(it);
+	}
+}
+
+void GLTextureCache::Clear()
+{
+	LOG_NOTICE(RSX, "GLTextureCache: hits=%d, misses=%d; uploaded=0x%llx bytes, not uploaded=0x%llx bytes",
+		m_hits, m_misses, m_uploaded_bytes, m_skipped_bytes);
+
+	for (auto& list : m_entries)
+	{
+		for (auto& entry : list.second)
+		{
+			entry.texture.Delete();
+		}
+	}
+
+	m_entries.clear();
+
+	m_hits = m_misses = 0;
+	m_uploaded_bytes = m_skipped_bytes = 0;
+	m_frame_uploaded_bytes = m_last_frame_uploaded_bytes = 0;
+}
+
 void PostDrawObj::Draw()
 {
 	static bool s_is_initialized = false;
@@ -784,9 +934,8 @@ void DrawCursorObj::InitializeLocations()
 GLGSRender::GLGSRender()
 	: GSRender()
 	, m_frame(nullptr)
-	, m_fp_buf_num(-1)
-	, m_vp_buf_num(-1)
 	, m_context(nullptr)
+	, m_readback_index(0)
 {
 	m_frame = GetGSFrame();
 }
@@ -851,11 +1000,8 @@ void GLGSRender::EnableVertexData(bool indexed_draw)
 		if (!m_vertex_data[i].IsEnabled()) continue;
 		const size_t item_size = m_vertex_data[i].GetTypeSize() * m_vertex_data[i].size;
 		const size_t data_size = m_vertex_data[i].data.size() - data_offset * item_size;
-		const u32 pos = m_vdata.size();
 
 		cur_offset += data_size;
-		m_vdata.resize(m_vdata.size() + data_size);
-		memcpy(&m_vdata[pos], &m_vertex_data[i].data[data_offset * item_size], data_size);
 	}
 
 	m_vao.Create();
@@ -864,7 +1010,20 @@ void GLGSRender::EnableVertexData(bool indexed_draw)
 
 	m_vbo.Create(indexed_draw ? 2 : 1);
 	m_vbo.Bind(0);
-	m_vbo.SetData(m_vdata.data(), m_vdata.size());
+	m_vbo.SetData(nullptr, cur_offset);
+
+	// upload the loaded vertex data directly (no intermediate copy)
+	for (u32 i = 0; i < m_vertex_count; ++i)
+	{
+		if (!m_vertex_data[i].IsEnabled()) continue;
+		const size_t item_size = m_vertex_data[i].GetTypeSize() * m_vertex_data[i].size;
+		const size_t data_size = m_vertex_data[i].data.size() - data_offset * item_size;
+
+		if (data_size)
+		{
+			m_vbo.SetSubData(&m_vertex_data[i].data[data_offset * item_size], offset_list[i], (u32)data_size);
+		}
+	}
 
 	if (indexed_draw)
 	{
@@ -1019,7 +1178,6 @@ void GLGSRender::EnableVertexData(bool indexed_draw)
 
 void GLGSRender::DisableVertexData()
 {
-	m_vdata.clear();
 	for (u32 i = 0; i < m_vertex_count; ++i)
 	{
 		if (!m_vertex_data[i].IsEnabled()) continue;
@@ -1110,37 +1268,41 @@ bool GLGSRender::LoadProgram()
 		return false;
 	}
 	
-	m_fp_buf_num = m_prog_buffer.SearchFp(*m_cur_fragment_prog, m_fragment_prog);
-	m_vp_buf_num = m_prog_buffer.SearchVp(*m_cur_vertex_prog, m_vertex_prog);
-
-	if (m_fp_buf_num == -1)
+	if (!m_prog_buffer.SearchFp(*m_cur_fragment_prog, m_fragment_prog))
 	{
-		LOG_WARNING(RSX, "FP not found in buffer!");
-		m_fragment_prog.Decompile(*m_cur_fragment_prog);
+		if (m_fragment_prog.shader.empty())
+		{
+			LOG_WARNING(RSX, "FP not found in buffer!");
+			m_fragment_prog.Decompile(*m_cur_fragment_prog);
+
+			// TODO: This shouldn't use current dir
+			rFile f("./FragmentProgram.txt", rFile::write);
+			f.Write(m_fragment_prog.shader);
+		}
+
 		m_fragment_prog.Compile();
 		checkForGlError("m_fragment_prog.Compile");
-
-		// TODO: This shouldn't use current dir
-		rFile f("./FragmentProgram.txt", rFile::write);
-		f.Write(m_fragment_prog.shader);
+		m_prog_buffer.AddFp(m_fragment_prog);
 	}
 
-	if (m_vp_buf_num == -1)
+	if (!m_prog_buffer.SearchVp(*m_cur_vertex_prog, m_vertex_prog))
 	{
-		LOG_WARNING(RSX, "VP not found in buffer!");
-		m_vertex_prog.Decompile(*m_cur_vertex_prog);
+		if (m_vertex_prog.shader.empty())
+		{
+			LOG_WARNING(RSX, "VP not found in buffer!");
+			m_vertex_prog.Decompile(*m_cur_vertex_prog);
+
+			// TODO: This shouldn't use current dir
+			rFile f("./VertexProgram.txt", rFile::write);
+			f.Write(m_vertex_prog.shader);
+		}
+
 		m_vertex_prog.Compile();
 		checkForGlError("m_vertex_prog.Compile");
-
-		// TODO: This shouldn't use current dir
-		rFile f("./VertexProgram.txt", rFile::write);
-		f.Write(m_vertex_prog.shader);
+		m_prog_buffer.AddVp(m_vertex_prog, *m_cur_vertex_prog);
 	}
 
-	if (m_fp_buf_num != -1 && m_vp_buf_num != -1)
-	{
-		m_program.id = m_prog_buffer.GetProg(m_fp_buf_num, m_vp_buf_num);
-	}
+	m_program.id = m_prog_buffer.GetProg(m_fragment_prog.id, m_vertex_prog.id);
 
 	if (m_program.id)
 	{
@@ -1178,8 +1340,7 @@ bool GLGSRender::LoadProgram()
 	{
 		m_program.Create(m_vertex_prog.id, m_fragment_prog.id);
 		checkForGlError("m_program.Create");
-		m_prog_buffer.Add(m_program, m_fragment_prog, *m_cur_fragment_prog, m_vertex_prog, *m_cur_vertex_prog);
-		checkForGlError("m_prog_buffer.Add");
+		m_prog_buffer.AddProg(m_program, m_fragment_prog, m_vertex_prog);
 		m_program.Use();
 
 		// RSX Debugger
@@ -1200,241 +1361,200 @@ bool GLGSRender::LoadProgram()
 
 void GLGSRender::WriteBuffers()
 {
-	if (Ini.GSDumpDepthBuffer.GetValue())
+	const bool dump_depth = Ini.GSDumpDepthBuffer.GetValue() && m_set_context_dma_z;
+	const bool dump_color = Ini.GSDumpColorBuffers.GetValue();
+
+	if (!dump_depth && !dump_color)
 	{
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[4]);
-		glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteDepthBuffer();
+		return;
 	}
 
-	if (Ini.GSDumpColorBuffers.GetValue())
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	if (dump_depth)
 	{
-		WriteColorBuffers();
+		ReadSurface(GL_NONE, m_surface_offset_z, m_context_dma_z);
 	}
-}
 
-void GLGSRender::WriteDepthBuffer()
-{
-	if (!m_set_context_dma_z)
+	if (!dump_color)
 	{
 		return;
 	}
 
-	u32 address = GetAddress(m_surface_offset_z, m_context_dma_z - 0xfeed0000);
-	if (!Memory.IsGoodAddr(address))
+	const bool is_set[4] = { m_set_context_dma_color_a, m_set_context_dma_color_b, m_set_context_dma_color_c, m_set_context_dma_color_d };
+	const u32 offsets[4] = { m_surface_offset_a, m_surface_offset_b, m_surface_offset_c, m_surface_offset_d };
+	const u32 dmas[4] = { m_context_dma_color_a, m_context_dma_color_b, m_context_dma_color_c, m_context_dma_color_d };
+
+	u32 first = 0, count = 0;
+
+	switch (m_surface_color_target)
 	{
-		LOG_WARNING(RSX, "Bad depth buffer address: address=0x%x, offset=0x%x, dma=0x%x", address, m_surface_offset_z, m_context_dma_z);
-		return;
+	case CELL_GCM_SURFACE_TARGET_0: count = 1; break;
+	case CELL_GCM_SURFACE_TARGET_1: first = 1; count = 1; break;
+	case CELL_GCM_SURFACE_TARGET_MRT1: count = 2; break;
+	case CELL_GCM_SURFACE_TARGET_MRT2: count = 3; break;
+	case CELL_GCM_SURFACE_TARGET_MRT3: count = 4; break;
 	}
 
-	auto ptr = vm::get_ptr<void>(address);
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[4]);
-	checkForGlError("WriteDepthBuffer(): glBindBuffer");
-	glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, 0);
-	checkForGlError("WriteDepthBuffer(): glReadPixels");
-	GLubyte *packed = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-	if (packed)
+	for (u32 i = first; i < first + count; i++)
 	{
-		memcpy(ptr, packed, RSXThread::m_width * RSXThread::m_height * 4);
-		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-		checkForGlError("WriteDepthBuffer(): glUnmapBuffer");
+		if (is_set[i])
+		{
+			ReadSurface(GL_COLOR_ATTACHMENT0 + i, offsets[i], dmas[i]);
+		}
 	}
-
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-
-	checkForGlError("WriteDepthBuffer(): glReadPixels");
-	glBindTexture(GL_TEXTURE_2D, g_depth_tex);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, RSXThread::m_width, RSXThread::m_height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, ptr);
-	checkForGlError("WriteDepthBuffer(): glTexImage2D");
-	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, ptr);
-	checkForGlError("WriteDepthBuffer(): glGetTexImage");
 }
 
-void GLGSRender::WriteColorBufferA()
+void GLGSRender::ReadSurface(GLenum buffer, u32 offset, u32 dma)
 {
-	if (!m_set_context_dma_color_a)
-	{
-		return;
-	}
+	// buffer is GL_NONE for the depth buffer
+	const u32 address = GetAddress(offset, dma - 0xfeed0000);
+	const u32 size = RSXThread::m_width * RSXThread::m_height * 4;
 
-	u32 address = GetAddress(m_surface_offset_a, m_context_dma_color_a - 0xfeed0000);
-	if (!Memory.IsGoodAddr(address))
+	if (!Memory.IsGoodAddr(address, size))
 	{
-		LOG_ERROR(RSX, "Bad color buffer A address: address=0x%x, offset=0x%x, dma=0x%x", address, m_surface_offset_a, m_context_dma_color_a);
+		LOG_ERROR(RSX, "Bad %s buffer address: address=0x%x, offset=0x%x, dma=0x%x", buffer == GL_NONE ? "depth" : "color", address, offset, dma);
 		return;
 	}
 
-	glReadBuffer(GL_COLOR_ATTACHMENT0);
-	checkForGlError("WriteColorBufferA(): glReadBuffer");
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[0]);
-	checkForGlError("WriteColorBufferA(): glBindBuffer");
-	glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, 0);
-	checkForGlError("WriteColorBufferA(): glReadPixels");
-	GLubyte *packed = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-	if (packed)
+	// pending data of the same surface is outdated and doesn't have to be copied
+	for (auto& rb : m_readbacks)
 	{
-		memcpy(vm::get_ptr<void>(address), packed, RSXThread::m_width * RSXThread::m_height * 4);
-		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-		checkForGlError("WriteColorBufferA(): glUnmapBuffer");
+		if (rb.fence && rb.addr == address && rb.size == size)
+		{
+			glDeleteSync(rb.fence);
+			rb.fence = nullptr;
+		}
 	}
 
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-}
+	GLReadback& rb = m_readbacks[m_readback_index];
+	m_readback_index = (m_readback_index + 1) % m_readback_count;
 
-void GLGSRender::WriteColorBufferB()
-{
-	if (!m_set_context_dma_color_b)
+	if (rb.fence)
 	{
-		return;
+		// the ring is full
+		FinishReadback(rb);
 	}
 
-	u32 address = GetAddress(m_surface_offset_b, m_context_dma_color_b - 0xfeed0000);
-	if (!Memory.IsGoodAddr(address))
-	{
-		LOG_ERROR(RSX, "Bad color buffer B address: address=0x%x, offset=0x%x, dma=0x%x", address, m_surface_offset_b, m_context_dma_color_b);
-		return;
-	}
+	rb.addr = address;
+	rb.size = size;
+	rb.depth = buffer == GL_NONE;
 
-	glReadBuffer(GL_COLOR_ATTACHMENT1);
-	checkForGlError("WriteColorBufferB(): glReadBuffer");
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[1]);
-	checkForGlError("WriteColorBufferB(): glBindBuffer");
-	glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, 0);
-	checkForGlError("WriteColorBufferB(): glReadPixels");
-	GLubyte *packed = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-	if (packed)
+	if (!rb.pbo)
 	{
-		memcpy(vm::get_ptr<void>(address), packed, RSXThread::m_width * RSXThread::m_height * 4);
-		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-		checkForGlError("WriteColorBufferB(): glUnmapBuffer");
+		glGenBuffers(1, &rb.pbo);
 	}
 
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.pbo);
+	checkForGlError("ReadSurface(): glBindBuffer");
 
-void GLGSRender::WriteColorBufferC()
-{
-	if (!m_set_context_dma_color_c)
+	if (rb.capacity < size)
 	{
-		return;
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, 0, GL_STREAM_READ);
+		checkForGlError("ReadSurface(): glBufferData");
+		rb.capacity = size;
 	}
 
-	u32 address = GetAddress(m_surface_offset_c, m_context_dma_color_c - 0xfeed0000);
-	if (!Memory.IsGoodAddr(address))
+	if (rb.depth)
 	{
-		LOG_ERROR(RSX, "Bad color buffer C address: address=0x%x, offset=0x%x, dma=0x%x", address, m_surface_offset_c, m_context_dma_color_c);
-		return;
+		glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, 0);
 	}
-
-	glReadBuffer(GL_COLOR_ATTACHMENT2);
-	checkForGlError("WriteColorBufferC(): glReadBuffer");
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[2]);
-	checkForGlError("WriteColorBufferC(): glBindBuffer");
-	glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, 0);
-	checkForGlError("WriteColorBufferC(): glReadPixels");
-	GLubyte *packed = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-	if (packed)
+	else
 	{
-		memcpy(vm::get_ptr<void>(address), packed, RSXThread::m_width * RSXThread::m_height * 4);
-		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-		checkForGlError("WriteColorBufferC(): glUnmapBuffer");
+		glReadBuffer(buffer);
+		checkForGlError("ReadSurface(): glReadBuffer");
+		glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, 0);
 	}
 
+	checkForGlError("ReadSurface(): glReadPixels");
 	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	rb.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	checkForGlError("ReadSurface(): glFenceSync");
 }
 
-void GLGSRender::WriteColorBufferD()
+void GLGSRender::FinishReadback(GLReadback& rb)
 {
-	if (!m_set_context_dma_color_d)
+	GLenum status;
+
+	do
+	{
+		// flushing makes sure the fence is eventually signaled
+		status = glClientWaitSync(rb.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+	}
+	while (status == GL_TIMEOUT_EXPIRED);
+
+	glDeleteSync(rb.fence);
+	rb.fence = nullptr;
+
+	if (status == GL_WAIT_FAILED)
 	{
+		LOG_ERROR(RSX, "FinishReadback(): glClientWaitSync failed (addr=0x%x)", rb.addr);
 		return;
 	}
 
-	u32 address = GetAddress(m_surface_offset_d, m_context_dma_color_d - 0xfeed0000);
-	if (!Memory.IsGoodAddr(address))
+	if (!Memory.IsGoodAddr(rb.addr, rb.size))
 	{
-		LOG_ERROR(RSX, "Bad color buffer D address: address=0x%x, offset=0x%x, dma=0x%x", address, m_surface_offset_d, m_context_dma_color_d);
+		// unmapped in the meantime
 		return;
 	}
 
-	glReadBuffer(GL_COLOR_ATTACHMENT3);
-	checkForGlError("WriteColorBufferD(): glReadBuffer");
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[3]);
-	checkForGlError("WriteColorBufferD(): glBindBuffer");
-	glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8, 0);
-	checkForGlError("WriteColorBufferD(): glReadPixels");
-	GLubyte *packed = (GLubyte *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-	if (packed)
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.pbo);
+	checkForGlError("FinishReadback(): glBindBuffer");
+
+	if (auto packed = (const u8*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY))
 	{
-		memcpy(vm::get_ptr<void>(address), packed, RSXThread::m_width * RSXThread::m_height * 4);
+		if (rb.depth)
+		{
+			// same result as the former upload of the depth bytes as GL_ALPHA and reading them back as GL_UNSIGNED_INT_8_8_8_8
+			u32* dst = vm::get_ptr<u32>(rb.addr);
+
+			for (u32 i = 0; i < rb.size / 4; i++)
+			{
+				dst[i] = packed[i];
+			}
+		}
+		else
+		{
+			memcpy(vm::get_ptr<void>(rb.addr), packed, rb.size);
+		}
+
 		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-		checkForGlError("WriteColorBufferD(): glUnmapBuffer");
+		checkForGlError("FinishReadback(): glUnmapBuffer");
 	}
 
 	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-
 }
 
-void GLGSRender::WriteColorBuffers()
+void GLGSRender::FlushSurfaces()
 {
-	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-	glPixelStorei(GL_PACK_ALIGNMENT, 4);
-
-	switch(m_surface_color_target)
+	// oldest first, so newer data of overlapping surfaces wins
+	for (u32 i = 0; i < m_readback_count; i++)
 	{
-	case CELL_GCM_SURFACE_TARGET_NONE:
-		return;
-
-	case CELL_GCM_SURFACE_TARGET_0:
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[0]);
-		glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteColorBufferA();
-	break;
-
-	case CELL_GCM_SURFACE_TARGET_1:
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[1]);
-		glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteColorBufferB();
-	break;
+		GLReadback& rb = m_readbacks[(m_readback_index + i) % m_readback_count];
 
-	case CELL_GCM_SURFACE_TARGET_MRT1:
-		for (int i = 0; i < 2; i++)
+		if (rb.fence)
 		{
-			glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[i]);
-			glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
+			FinishReadback(rb);
 		}
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteColorBufferA();
-		WriteColorBufferB();
-	break;
+	}
+}
 
-	case CELL_GCM_SURFACE_TARGET_MRT2:
-		for (int i = 0; i < 3; i++)
-		{
-			glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[i]);
-			glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
-		}
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteColorBufferA();
-		WriteColorBufferB();
-		WriteColorBufferC();
-	break;
+void GLGSRender::FlushTextureSurfaces(RSXTexture& tex)
+{
+	// surfaces rendered earlier in the command stream can be sampled without any semaphore in between
+	const u32 addr = GetAddress(tex.GetOffset(), tex.GetLocation());
+	const u32 size = std::max<u32>(GLTexture::GetDataSize(tex), 1);
 
-	case CELL_GCM_SURFACE_TARGET_MRT3:
-		for (int i = 0; i < 4; i++)
+	for (u32 i = 0; i < m_readback_count; i++)
+	{
+		GLReadback& rb = m_readbacks[(m_readback_index + i) % m_readback_count];
+
+		if (rb.fence && rb.addr < addr + size && addr < rb.addr + rb.size)
 		{
-			glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[i]);
-			glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
+			FinishReadback(rb);
 		}
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		WriteColorBufferA();
-		WriteColorBufferB();
-		WriteColorBufferC();
-		WriteColorBufferD();
-	break;
 	}
 }
 
@@ -1465,9 +1585,8 @@ void GLGSRender::OnInitThread()
 	glEnable(GL_TEXTURE_2D);
 	glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
-	glGenTextures(1, &g_depth_tex);
 	glGenTextures(1, &g_flip_tex);
-	glGenBuffers(6, g_pbo); // 4 for color buffers + 1 for depth buffer + 1 for flip()
+	glGenBuffers(1, &g_flip_pbo);
 
 #ifdef _WIN32
 	glSwapInterval(Ini.GSVSyncEnable.GetValue() ? 1 : 0);
@@ -1478,8 +1597,18 @@ void GLGSRender::OnInitThread()
 void GLGSRender::OnExitThread()
 {
 	glDeleteTextures(1, &g_flip_tex);
-	glDeleteTextures(1, &g_depth_tex);
-	glDeleteBuffers(6, g_pbo);
+	glDeleteBuffers(1, &g_flip_pbo);
+
+	for (auto& rb : m_readbacks)
+	{
+		if (rb.fence)
+		{
+			glDeleteSync(rb.fence);
+		}
+
+		glDeleteBuffers(1, &rb.pbo);
+		rb = GLReadback();
+	}
 	
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
@@ -1490,6 +1619,7 @@ void GLGSRender::OnExitThread()
 	m_vbo.Delete();
 	m_vao.Delete();
 	m_prog_buffer.Clear();
+	m_texture_cache.Clear();
 }
 
 void GLGSRender::OnReset()
@@ -1959,28 +2089,24 @@ void GLGSRender::ExecCMD()
 	{
 		if (!m_textures[i].IsEnabled()) continue;
 
+		FlushTextureSurfaces(m_textures[i]);
 		glActiveTexture(GL_TEXTURE0 + i);
 		checkForGlError("glActiveTexture");
-		m_gl_textures[i].Create();
-		m_gl_textures[i].Bind();
-		checkForGlError(fmt::Format("m_gl_textures[%d].Bind", i));
+		m_texture_cache.Bind(m_textures[i], m_texture_converter);
+		checkForGlError(fmt::Format("m_texture_cache.Bind(%d)", i));
 		m_program.SetTex(i);
-		m_gl_textures[i].Init(m_textures[i]);
-		checkForGlError(fmt::Format("m_gl_textures[%d].Init", i));
 	}
 
 	for (u32 i = 0; i < m_textures_count; ++i)
 	{
 		if (!m_vertex_textures[i].IsEnabled()) continue;
 
+		FlushTextureSurfaces(m_vertex_textures[i]);
 		glActiveTexture(GL_TEXTURE0 + m_textures_count + i);
 		checkForGlError("glActiveTexture");
-		m_gl_vertex_textures[i].Create();
-		m_gl_vertex_textures[i].Bind();
-		checkForGlError(fmt::Format("m_gl_vertex_textures[%d].Bind", i));
+		m_texture_cache.Bind(m_vertex_textures[i], m_texture_converter);
+		checkForGlError(fmt::Format("m_texture_cache.Bind(vertex %d)", i));
 		m_program.SetVTex(i);
-		m_gl_vertex_textures[i].Init(m_vertex_textures[i]);
-		checkForGlError(fmt::Format("m_gl_vertex_textures[%d].Init", i));
 	}
 
 	m_vao.Bind();
@@ -2039,6 +2165,8 @@ void GLGSRender::Flip()
 	static u32 height = 0;
 	GLenum format = GL_RGBA;
 
+	FlushSurfaces();
+
 	if (m_read_buffer)
 	{
 		format = GL_BGRA;
@@ -2062,7 +2190,7 @@ void GLGSRender::Flip()
 		static std::vector<u8> pixels;
 		pixels.resize(RSXThread::m_width * RSXThread::m_height * 4);
 		m_fbo.Bind(GL_READ_FRAMEBUFFER);
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, g_pbo[5]);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, g_flip_pbo);
 		glBufferData(GL_PIXEL_PACK_BUFFER, RSXThread::m_width * RSXThread::m_height * 4, 0, GL_STREAM_READ);
 		glReadPixels(0, 0, RSXThread::m_width, RSXThread::m_height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, 0);
 		checkForGlError("Flip(): glReadPixels(GL_BGRA, GL_UNSIGNED_INT_8_8_8_8)");
@@ -2133,35 +2261,6 @@ void GLGSRender::Flip()
 	}
 
 	m_frame->Flip(m_context);
-	
-}
 
-u32 LinearToSwizzleAddress(u32 x, u32 y, u32 z, u32 log2_width, u32 log2_height, u32 log2_depth)
-{
-	u32 offset = 0;
-	u32 shift_count = 0;
-	while (log2_width | log2_height | log2_depth){
-		if (log2_width)
-		{
-			offset |= (x & 0x01) << shift_count;
-			x >>= 1;
-			++shift_count;
-			--log2_width;
-		}
-		if (log2_height)
-		{
-			offset |= (y & 0x01) << shift_count;
-			y >>= 1;
-			++shift_count;
-			--log2_height;
-		}
-		if (log2_depth)
-		{
-			offset |= (z & 0x01) << shift_count;
-			z >>= 1;
-			++shift_count;
-			--log2_depth;
-		}
-	}
-	return offset;
+	m_texture_cache.EndFrame();
 }
@@ -2,6 +2,7 @@
 #include "Emu/RSX/GSRender.h"
 #include "GLBuffers.h"
 #include "GLProgramBuffer.h"
+#include "Emu/RSX/RSXTextureConverter.h"
 
 #pragma comment(lib, "opengl32.lib")
 
@@ -10,7 +11,6 @@
 extern GLenum g_last_gl_error;
 void printGlError(GLenum err, const char* situation);
 void printGlError(GLenum err, const std::string& situation);
-u32 LinearToSwizzleAddress(u32 x, u32 y, u32 z, u32 log2_width, u32 log2_height, u32 log2_depth);
 
 #if RSX_DEBUG
 #define checkForGlError(sit) if((g_last_gl_error = glGetError()) != GL_NO_ERROR) printGlError(g_last_gl_error, sit)
@@ -51,7 +51,17 @@ public:
 		return (v << 2) | (v >> 4);
 	}
 
-	void Init(RSXTexture& tex);
+	// bytes per texel of the formats which can be unswizzled (0 for the others)
+	static u32 GetTexelSize(int format);
+
+	// size of the texture data in memory (0 if unknown)
+	static u32 GetDataSize(RSXTexture& tex);
+
+	// upload the texture data and set all parameters
+	void Init(RSXTexture& tex, RSXTextureConverter& converter);
+
+	// set the parameters which aren't part of the texture cache key
+	void SetSamplerState(RSXTexture& tex);
 
 	void Save(RSXTexture& tex, const std::string& name);
 
@@ -64,6 +74,58 @@ public:
 	void Delete();
 };
 
+// GL textures reused while the texture data in guest memory doesn't change (detected by hashing it on each bind)
+class GLTextureCache
+{
+	struct Entry
+	{
+		GLTexture texture;
+		u32 addr, format, width, height, pitch, remap, mipmap; // key
+		u64 hash; // hash of the uploaded data
+		u32 last_used; // frame number
+	};
+
+	std::unordered_map<u32, std::vector<Entry>> m_entries; // by address
+	u32 m_frame;
+
+public:
+	u32 m_hits, m_misses;
+	u64 m_uploaded_bytes, m_skipped_bytes; // texture data uploaded and not uploaded again
+	u64 m_frame_uploaded_bytes, m_last_frame_uploaded_bytes;
+
+	GLTextureCache();
+
+	// bind the texture to the active texture unit, the data is uploaded if it isn't cached or has changed
+	void Bind(RSXTexture& tex, RSXTextureConverter& converter);
+
+	// count frames and delete textures which weren't used recently
+	void EndFrame();
+
+	void Clear();
+
+	static u64 Hash(const u8* data, u32 size);
+};
+
+// surface read to a pixel pack buffer, copied to guest memory when the fence is reached and the data is needed
+struct GLReadback
+{
+	GLuint pbo;
+	GLsync fence; // nullptr if nothing is pending
+	u32 capacity; // allocated size of the buffer
+	u32 addr, size;
+	bool depth; // depth values are expanded from 8 to 32 bits
+
+	GLReadback()
+		: pbo(0)
+		, fence(nullptr)
+		, capacity(0)
+		, addr(0)
+		, size(0)
+		, depth(false)
+	{
+	}
+};
+
 class PostDrawObj
 {
 protected:
@@ -136,19 +198,20 @@ class GLGSRender //TODO: find out why this used to inherit from wxWindow
 	/*,*/ public GSRender
 {
 private:
-	std::vector<u8> m_vdata;
 	std::vector<PostDrawObj> m_post_draw_objs;
+	RSXTextureConverter m_texture_converter;
 
 	GLProgram m_program;
-	int m_fp_buf_num;
-	int m_vp_buf_num;
 	GLProgramBuffer m_prog_buffer;
 
 	GLFragmentProgram m_fragment_prog;
 	GLVertexProgram m_vertex_prog;
 
-	GLTexture m_gl_textures[m_textures_count];
-	GLTexture m_gl_vertex_textures[m_textures_count];
+	GLTextureCache m_texture_cache;
+
+	static const u32 m_readback_count = 8;
+	GLReadback m_readbacks[m_readback_count]; // ring, m_readback_index is the oldest entry
+	u32 m_readback_index;
 
 	GLvao m_vao;
 	GLvbo m_vbo;
@@ -174,12 +237,9 @@ private:
 	virtual void Close();
 	bool LoadProgram();
 	void WriteBuffers();
-	void WriteDepthBuffer();
-	void WriteColorBuffers();
-	void WriteColorBufferA();
-	void WriteColorBufferB();
-	void WriteColorBufferC();
-	void WriteColorBufferD();
+	void ReadSurface(GLenum buffer, u32 offset, u32 dma);
+	void FinishReadback(GLReadback& rb);
+	void FlushTextureSurfaces(RSXTexture& tex);
 
 	void DrawObjects();
 	void InitDrawBuffers();
@@ -226,4 +286,5 @@ protected:
 	virtual void StencilMaskSeparate(u32 mode, u32 mask);
 	virtual void StencilFuncSeparate(u32 mode, u32 func, u32 ref, u32 mask);
 	virtual void Flip();
+	virtual void FlushSurfaces();
 };
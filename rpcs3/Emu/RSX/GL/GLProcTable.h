@@ -9,6 +9,9 @@ OPENGL_PROC(PFNGLMAPBUFFERPROC, MapBuffer);
 OPENGL_PROC(PFNGLUNMAPBUFFERPROC, UnmapBuffer);
 OPENGL_PROC(PFNGLGETBUFFERPARAMETERIVPROC, GetBufferParameteriv);
 OPENGL_PROC(PFNGLGETBUFFERPOINTERVPROC, GetBufferPointerv);
+OPENGL_PROC(PFNGLFENCESYNCPROC, FenceSync);
+OPENGL_PROC(PFNGLCLIENTWAITSYNCPROC, ClientWaitSync);
+OPENGL_PROC(PFNGLDELETESYNCPROC, DeleteSync);
 OPENGL_PROC(PFNGLBLENDFUNCSEPARATEPROC, BlendFuncSeparate);
 OPENGL_PROC(PFNGLBLENDEQUATIONSEPARATEPROC, BlendEquationSeparate);
 OPENGL_PROC(PFNGLCREATESHADERPROC, CreateShader);
@@ -1,134 +1,356 @@
 #include "stdafx.h"
 #include "Utilities/Log.h"
+#include "Utilities/rFile.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
 
 #include "GLProgramBuffer.h"
 
-int GLProgramBuffer::SearchFp(const RSXFragmentProgram& rsx_fp, GLFragmentProgram& gl_fp)
+GLProgramBuffer::GLProgramBuffer()
+	: m_fp_hits(0)
+	, m_fp_misses(0)
+	, m_vp_hits(0)
+	, m_vp_misses(0)
+	, m_disk_hits(0)
 {
-	for(u32 i=0; i<m_buf.size(); ++i)
-	{
-		if(memcmp(&m_buf[i].fp_data[0], vm::get_ptr<void>(rsx_fp.addr), m_buf[i].fp_data.size()) != 0) continue;
+}
 
-		gl_fp.id = m_buf[i].fp_id;
-		gl_fp.shader = m_buf[i].fp_shader.c_str();
+u64 GLProgramBuffer::Hash(const void* data, size_t size)
+{
+	// FNV-1a (64 bit), the microcode is also compared on lookup so collisions are harmless
+	const u8* ptr = static_cast<const u8*>(data);
+	u64 hash = 0xcbf29ce484222325ull;
 
-		return i;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= ptr[i];
+		hash *= 0x100000001b3ull;
 	}
 
-	return -1;
+	return hash;
 }
 
-int GLProgramBuffer::SearchVp(const RSXVertexProgram& rsx_vp, GLVertexProgram& gl_vp)
+// sources read by the code GLFragmentDecompilerThread generates for the opcode (bit n set for src n)
+static u32 GetFpSrcMask(u32 opcode)
 {
-	for(u32 i=0; i<m_buf.size(); ++i)
+	switch (opcode)
 	{
-		if(m_buf[i].vp_data.size() != rsx_vp.data.size()) continue;
-		if(memcmp(m_buf[i].vp_data.data(), rsx_vp.data.data(), rsx_vp.data.size() * 4) != 0) continue;
+	case RSX_FP_OPCODE_MOV:
+	case RSX_FP_OPCODE_RCP:
+	case RSX_FP_OPCODE_RSQ:
+	case RSX_FP_OPCODE_COS:
+	case RSX_FP_OPCODE_SIN:
+	case RSX_FP_OPCODE_EX2:
+	case RSX_FP_OPCODE_LG2:
+	case RSX_FP_OPCODE_FLR:
+	case RSX_FP_OPCODE_FRC:
+	case RSX_FP_OPCODE_LIT:
+	case RSX_FP_OPCODE_LIF:
+	case RSX_FP_OPCODE_PK2:
+	case RSX_FP_OPCODE_PK4:
+	case RSX_FP_OPCODE_UP2:
+	case RSX_FP_OPCODE_UP4:
+	case RSX_FP_OPCODE_DDX:
+	case RSX_FP_OPCODE_DDY:
+	case RSX_FP_OPCODE_NRM:
+	case RSX_FP_OPCODE_TEX:
+		return 1;
 
-		gl_vp.id = m_buf[i].vp_id;
-		gl_vp.shader = m_buf[i].vp_shader.c_str();
+	case RSX_FP_OPCODE_ADD:
+	case RSX_FP_OPCODE_MUL:
+	case RSX_FP_OPCODE_DIV:
+	case RSX_FP_OPCODE_DIVSQ:
+	case RSX_FP_OPCODE_DP2:
+	case RSX_FP_OPCODE_DP3:
+	case RSX_FP_OPCODE_DP4:
+	case RSX_FP_OPCODE_DST:
+	case RSX_FP_OPCODE_MIN:
+	case RSX_FP_OPCODE_MAX:
+	case RSX_FP_OPCODE_SEQ:
+	case RSX_FP_OPCODE_SNE:
+	case RSX_FP_OPCODE_SGE:
+	case RSX_FP_OPCODE_SGT:
+	case RSX_FP_OPCODE_SLE:
+	case RSX_FP_OPCODE_SLT:
+	case RSX_FP_OPCODE_TXP:
+	case RSX_FP_OPCODE_TXB:
+	case RSX_FP_OPCODE_TXL:
+		return 3;
 
-		return i;
+	case RSX_FP_OPCODE_MAD:
+	case RSX_FP_OPCODE_DP2A:
+		return 7;
+
+	default:
+		// NOP, KIL, STR, SFL, flow control and unimplemented instructions
+		return 0;
 	}
+}
 
-	return -1;
+u32 GLProgramBuffer::GetFpSize(const RSXFragmentProgram& rsx_fp)
+{
+	// walk the instructions the same way GLFragmentDecompilerThread does: 16 bytes each,
+	// followed by an inline constant if one of the sources actually read is a constant register
+	auto data = vm::ptr<u32>::make(rsx_fp.addr);
+	u32 size = 0;
+
+	while (true)
+	{
+		GLFragmentDecompilerThread::OPDEST dst;
+		GLFragmentDecompilerThread::SRC1 src1;
+		dst.HEX = data[0] << 16 | data[0] >> 16;
+		src1.HEX = data[2] << 16 | data[2] >> 16;
+
+		const u32 src_mask = GetFpSrcMask(dst.opcode | (src1.opcode_is_branch << 6));
+		bool has_const = false;
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			const u32 src = data[i + 1] << 16 | data[i + 1] >> 16;
+			has_const |= (src_mask & (1 << i)) && (src & 0x3) == 2;
+		}
+
+		const u32 offset = has_const ? 2 * 4 * sizeof(u32) : 4 * sizeof(u32);
+		size += offset;
+
+		if (dst.end) break;
+
+		data += offset / sizeof(u32);
+	}
+
+	return size;
 }
 
-bool GLProgramBuffer::CmpVP(const u32 a, const u32 b) const
+void GLProgramBuffer::GetFpData(const RSXFragmentProgram& rsx_fp, std::vector<u8>& data)
 {
-	if(m_buf[a].vp_data.size() != m_buf[b].vp_data.size()) return false;
-	return memcmp(m_buf[a].vp_data.data(), m_buf[b].vp_data.data(), m_buf[a].vp_data.size() * 4) == 0;
+	const u32 size = GetFpSize(rsx_fp);
+
+	// ctrl affects the decompiled shader too
+	data.resize(size + sizeof(u32));
+	memcpy(data.data(), vm::get_ptr<void>(rsx_fp.addr), size);
+	memcpy(data.data() + size, &rsx_fp.ctrl, sizeof(u32));
 }
 
-bool GLProgramBuffer::CmpFP(const u32 a, const u32 b) const
+std::string GLProgramBuffer::GetCachePath()
 {
-	if(m_buf[a].fp_data.size() != m_buf[b].fp_data.size()) return false;
-	return memcmp(m_buf[a].fp_data.data(), m_buf[b].fp_data.data(), m_buf[a].fp_data.size()) == 0;
+	const std::string title_id = Emu.GetTitleID();
+
+	return "./data/cache/" + (title_id.length() ? title_id : std::string("unknown")) + "/shaders/";
 }
 
-u32 GLProgramBuffer::GetProg(u32 fp, u32 vp) const
+bool GLProgramBuffer::LoadShader(const std::string& path, const std::vector<u8>& data, std::string& shader)
 {
-	if(fp == vp)
+	if (!rExists(path))
 	{
-		/*
-		LOG_NOTICE(RSX, "Get program (%d):", fp);
-		LOG_NOTICE(RSX, "*** prog id = %d", m_buf[fp].prog_id);
-		LOG_NOTICE(RSX, "*** vp id = %d", m_buf[fp].vp_id);
-		LOG_NOTICE(RSX, "*** fp id = %d", m_buf[fp].fp_id);
+		return false;
+	}
+
+	rFile f(path, rFile::read);
 
-		LOG_NOTICE(RSX, "*** vp shader = \n%s", m_buf[fp].vp_shader.wx_str());
-		LOG_NOTICE(RSX, "*** fp shader = \n%s", m_buf[fp].fp_shader.wx_str());
-		*/
-		return m_buf[fp].prog_id;
+	u32 size;
+	if (!f.IsOpened() || f.Read(&size, sizeof(u32)) != sizeof(u32) || size != data.size())
+	{
+		return false;
 	}
 
-	for(u32 i=0; i<m_buf.size(); ++i)
+	std::vector<u8> file_data(size);
+	if (f.Read(file_data.data(), size) != size || file_data != data)
 	{
-		if(i == fp || i == vp) continue;
+		// hash collision or different microcode
+		return false;
+	}
 
-		if(CmpVP(vp, i) && CmpFP(fp, i))
+	shader.resize(f.Length() - f.Tell());
+	return shader.empty() || f.Read(&shader[0], shader.size()) == shader.size();
+}
+
+void GLProgramBuffer::SaveShader(const std::string& path, const std::vector<u8>& data, const std::string& shader)
+{
+	const std::string dir = GetCachePath();
+
+	if (!rExists(dir) && !rMkpath(dir))
+	{
+		LOG_ERROR(RSX, "GLProgramBuffer: failed to create '%s'", dir.c_str());
+		return;
+	}
+
+	rFile f(path, rFile::write);
+
+	if (!f.IsOpened())
+	{
+		LOG_ERROR(RSX, "GLProgramBuffer: failed to write '%s'", path.c_str());
+		return;
+	}
+
+	const u32 size = (u32)data.size();
+	f.Write(&size, sizeof(u32));
+	f.Write(data.data(), data.size());
+	f.Write(shader);
+}
+
+bool GLProgramBuffer::SearchFp(RSXFragmentProgram& rsx_fp, GLFragmentProgram& gl_fp)
+{
+	GetFpData(rsx_fp, m_fp_data);
+	rsx_fp.size = (u32)m_fp_data.size() - sizeof(u32);
+
+	const u64 hash = Hash(m_fp_data.data(), m_fp_data.size());
+
+	auto found = m_fp_buf.find(hash);
+	if (found != m_fp_buf.end())
+	{
+		for (auto& info : found->second)
 		{
-			/*
-			LOG_NOTICE(RSX, "Get program (%d):", i);
-			LOG_NOTICE(RSX, "*** prog id = %d", m_buf[i].prog_id);
-			LOG_NOTICE(RSX, "*** vp id = %d", m_buf[i].vp_id);
-			LOG_NOTICE(RSX, "*** fp id = %d", m_buf[i].fp_id);
-
-			LOG_NOTICE(RSX, "*** vp shader = \n%s", m_buf[i].vp_shader.wx_str());
-			LOG_NOTICE(RSX, "*** fp shader = \n%s", m_buf[i].fp_shader.wx_str());
-			*/
-			return m_buf[i].prog_id;
+			if (info.data == m_fp_data)
+			{
+				gl_fp.id = info.id;
+				gl_fp.shader = info.shader;
+				m_fp_hits++;
+				return true;
+			}
 		}
 	}
 
-	return 0;
+	m_fp_misses++;
+
+	gl_fp.id = 0; // don't let Compile() delete the cached shader
+	gl_fp.shader.clear();
+
+	if (LoadShader(GetCachePath() + fmt::Format("fp_%016llx.bin", hash), m_fp_data, gl_fp.shader))
+	{
+		m_disk_hits++;
+	}
+	else
+	{
+		gl_fp.shader.clear();
+	}
+
+	return false;
 }
 
-void GLProgramBuffer::Add(GLProgram& prog, GLFragmentProgram& gl_fp, RSXFragmentProgram& rsx_fp, GLVertexProgram& gl_vp, RSXVertexProgram& rsx_vp)
+bool GLProgramBuffer::SearchVp(const RSXVertexProgram& rsx_vp, GLVertexProgram& gl_vp)
 {
-	GLBufferInfo new_buf;
+	const u64 hash = Hash(rsx_vp.data.data(), rsx_vp.data.size() * sizeof(u32));
 
-	LOG_NOTICE(RSX, "Add program (%d):", m_buf.size());
-	LOG_NOTICE(RSX, "*** prog id = %d", prog.id);
-	LOG_NOTICE(RSX, "*** vp id = %d", gl_vp.id);
-	LOG_NOTICE(RSX, "*** fp id = %d", gl_fp.id);
-	LOG_NOTICE(RSX, "*** vp data size = %d", rsx_vp.data.size() * 4);
-	LOG_NOTICE(RSX, "*** fp data size = %d", rsx_fp.size);
+	auto found = m_vp_buf.find(hash);
+	if (found != m_vp_buf.end())
+	{
+		for (auto& info : found->second)
+		{
+			if (info.data.size() == rsx_vp.data.size() * sizeof(u32) && memcmp(info.data.data(), rsx_vp.data.data(), info.data.size()) == 0)
+			{
+				gl_vp.id = info.id;
+				gl_vp.shader = info.shader;
+				m_vp_hits++;
+				return true;
+			}
+		}
+	}
 
-	LOG_NOTICE(RSX, "*** vp shader = \n%s", gl_vp.shader.c_str());
-	LOG_NOTICE(RSX, "*** fp shader = \n%s", gl_fp.shader.c_str());
-	
+	m_vp_misses++;
 
-	new_buf.prog_id = prog.id;
-	new_buf.vp_id = gl_vp.id;
-	new_buf.fp_id = gl_fp.id;
+	gl_vp.id = 0;
+	gl_vp.shader.clear();
 
-	new_buf.fp_data.insert(new_buf.fp_data.end(), vm::get_ptr<u8>(rsx_fp.addr), vm::get_ptr<u8>(rsx_fp.addr + rsx_fp.size));
-	new_buf.vp_data = rsx_vp.data;
+	const std::vector<u8> data((const u8*)rsx_vp.data.data(), (const u8*)(rsx_vp.data.data() + rsx_vp.data.size()));
 
-	new_buf.vp_shader = gl_vp.shader;
-	new_buf.fp_shader = gl_fp.shader;
+	if (LoadShader(GetCachePath() + fmt::Format("vp_%016llx.bin", hash), data, gl_vp.shader))
+	{
+		m_disk_hits++;
+	}
+	else
+	{
+		gl_vp.shader.clear();
+	}
 
-	m_buf.push_back(new_buf);
+	return false;
+}
+
+u32 GLProgramBuffer::GetProg(u32 fp_id, u32 vp_id) const
+{
+	auto found = m_prog_buf.find((u64)fp_id << 32 | vp_id);
+
+	return found != m_prog_buf.end() ? found->second : 0;
+}
+
+void GLProgramBuffer::AddFp(GLFragmentProgram& gl_fp)
+{
+	GLShaderInfo info;
+	info.id = gl_fp.id;
+	info.data = m_fp_data;
+	info.shader = gl_fp.shader;
+
+	const u64 hash = Hash(info.data.data(), info.data.size());
+
+	const std::string path = GetCachePath() + fmt::Format("fp_%016llx.bin", hash);
+
+	if (!rExists(path))
+	{
+		SaveShader(path, info.data, info.shader);
+	}
+
+	m_fp_buf[hash].push_back(std::move(info));
+}
+
+void GLProgramBuffer::AddVp(GLVertexProgram& gl_vp, RSXVertexProgram& rsx_vp)
+{
+	GLShaderInfo info;
+	info.id = gl_vp.id;
+	info.data.assign((const u8*)rsx_vp.data.data(), (const u8*)(rsx_vp.data.data() + rsx_vp.data.size()));
+	info.shader = gl_vp.shader;
+
+	const u64 hash = Hash(info.data.data(), info.data.size());
+
+	const std::string path = GetCachePath() + fmt::Format("vp_%016llx.bin", hash);
+
+	if (!rExists(path))
+	{
+		SaveShader(path, info.data, info.shader);
+	}
+
+	m_vp_buf[hash].push_back(std::move(info));
+}
+
+void GLProgramBuffer::AddProg(GLProgram& prog, GLFragmentProgram& gl_fp, GLVertexProgram& gl_vp)
+{
+	LOG_NOTICE(RSX, "Add program (%d):", m_prog_buf.size());
+	LOG_NOTICE(RSX, "*** prog id = %d", prog.id);
+	LOG_NOTICE(RSX, "*** vp id = %d", gl_vp.id);
+	LOG_NOTICE(RSX, "*** fp id = %d", gl_fp.id);
+
+	m_prog_buf[(u64)gl_fp.id << 32 | gl_vp.id] = prog.id;
 }
 
 void GLProgramBuffer::Clear()
 {
-	for (u32 i = 0; i < m_buf.size(); ++i)
+	LOG_NOTICE(RSX, "GLProgramBuffer: fp hits=%d, misses=%d; vp hits=%d, misses=%d; loaded from disk=%d; programs=%d",
+		m_fp_hits, m_fp_misses, m_vp_hits, m_vp_misses, m_disk_hits, m_prog_buf.size());
+
+	for (auto& prog : m_prog_buf)
 	{
-		glDetachShader(m_buf[i].prog_id, m_buf[i].fp_id);
-		glDetachShader(m_buf[i].prog_id, m_buf[i].vp_id);
-		glDeleteShader(m_buf[i].fp_id);
-		glDeleteShader(m_buf[i].vp_id);
-		glDeleteProgram(m_buf[i].prog_id);
+		glDeleteProgram(prog.second);
+	}
 
-		m_buf[i].fp_data.clear();
-		m_buf[i].vp_data.clear();
+	for (auto& list : m_fp_buf)
+	{
+		for (auto& info : list.second)
+		{
+			glDeleteShader(info.id);
+		}
+	}
 
-		m_buf[i].vp_shader.clear();
-		m_buf[i].fp_shader.clear();
+	for (auto& list : m_vp_buf)
+	{
+		for (auto& info : list.second)
+		{
+			glDeleteShader(info.id);
+		}
 	}
 
-	m_buf.clear();
+	m_prog_buf.clear();
+	m_fp_buf.clear();
+	m_vp_buf.clear();
+
+	m_fp_hits = m_fp_misses = 0;
+	m_vp_hits = m_vp_misses = 0;
+	m_disk_hits = 0;
 }
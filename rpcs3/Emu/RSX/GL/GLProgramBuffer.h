@@ -1,29 +1,45 @@
 #pragma once
 #include "GLProgram.h"
 
-struct GLBufferInfo
+struct GLShaderInfo
 {
-	u32 prog_id;
-	u32 fp_id;
-	u32 vp_id;
-	std::vector<u8> fp_data;
-	std::vector<u32> vp_data;
-	std::string fp_shader;
-	std::string vp_shader;
+	u32 id;
+	std::vector<u8> data; // RSX microcode (fragment program: followed by ctrl)
+	std::string shader; // decompiled GLSL
 };
 
 struct GLProgramBuffer
 {
-	std::vector<GLBufferInfo> m_buf;
+	// shaders and programs keyed by the hash of the RSX microcode
+	std::unordered_map<u64, std::vector<GLShaderInfo>> m_fp_buf;
+	std::unordered_map<u64, std::vector<GLShaderInfo>> m_vp_buf;
+	std::unordered_map<u64, u32> m_prog_buf; // (fp id << 32 | vp id) -> program id
 
-	int SearchFp(const RSXFragmentProgram& rsx_fp, GLFragmentProgram& gl_fp);
-	int SearchVp(const RSXVertexProgram& rsx_vp, GLVertexProgram& gl_vp);
+	u32 m_fp_hits, m_fp_misses;
+	u32 m_vp_hits, m_vp_misses;
+	u32 m_disk_hits;
 
-	bool CmpVP(const u32 a, const u32 b) const;
-	bool CmpFP(const u32 a, const u32 b) const;
+	GLProgramBuffer();
 
-	u32 GetProg(u32 fp, u32 vp) const;
+	// return false if the shader isn't compiled yet (gl_fp.shader is set if the disk cache had it)
+	bool SearchFp(RSXFragmentProgram& rsx_fp, GLFragmentProgram& gl_fp);
+	bool SearchVp(const RSXVertexProgram& rsx_vp, GLVertexProgram& gl_vp);
 
-	void Add(GLProgram& prog, GLFragmentProgram& gl_fp, RSXFragmentProgram& rsx_fp, GLVertexProgram& gl_vp, RSXVertexProgram& rsx_vp);
+	u32 GetProg(u32 fp_id, u32 vp_id) const;
+
+	void AddFp(GLFragmentProgram& gl_fp); // uses the microcode of the last SearchFp() call
+	void AddVp(GLVertexProgram& gl_vp, RSXVertexProgram& rsx_vp);
+	void AddProg(GLProgram& prog, GLFragmentProgram& gl_fp, GLVertexProgram& gl_vp);
 	void Clear();
+
+	static u32 GetFpSize(const RSXFragmentProgram& rsx_fp);
+	static void GetFpData(const RSXFragmentProgram& rsx_fp, std::vector<u8>& data);
+	static u64 Hash(const void* data, size_t size);
+
+private:
+	std::vector<u8> m_fp_data; // temporary microcode copy for the current fragment program
+
+	static std::string GetCachePath();
+	static bool LoadShader(const std::string& path, const std::vector<u8>& data, std::string& shader);
+	static void SaveShader(const std::string& path, const std::vector<u8>& data, const std::string& shader);
 };
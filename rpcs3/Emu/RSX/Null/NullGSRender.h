@@ -51,5 +51,6 @@ private:
 	virtual void StencilMaskSeparate(u32 mode, u32 mask) {}
 	virtual void StencilFuncSeparate(u32 mode, u32 func, u32 ref, u32 mask) {}
 	virtual void Flip() {}
+	virtual void FlushSurfaces() {}
 	virtual void Close() {}
 };
@@ -0,0 +1,238 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "RSXTextureConverter.h"
+
+u32 LinearToSwizzleAddress(u32 x, u32 y, u32 z, u32 log2_width, u32 log2_height, u32 log2_depth)
+{
+	u32 offset = 0;
+	u32 shift_count = 0;
+	while (log2_width | log2_height | log2_depth){
+		if (log2_width)
+		{
+			offset |= (x & 0x01) << shift_count;
+			x >>= 1;
+			++shift_count;
+			--log2_width;
+		}
+		if (log2_height)
+		{
+			offset |= (y & 0x01) << shift_count;
+			y >>= 1;
+			++shift_count;
+			--log2_height;
+		}
+		if (log2_depth)
+		{
+			offset |= (z & 0x01) << shift_count;
+			z >>= 1;
+			++shift_count;
+			--log2_depth;
+		}
+	}
+	return offset;
+}
+
+namespace
+{
+	struct u128_texel
+	{
+		u64 lo, hi;
+	};
+
+	u32 FloorLog2(u32 value)
+	{
+		u32 result = 0;
+		while (value >>= 1) result++;
+		return result;
+	}
+
+	// the swizzled offset is the sum of independent x and y parts, so each texel only needs two table lookups
+	template<typename T>
+	void UnswizzleTexels(T* dst, const T* src, u32 width, u32 height, const u32* x_offsets, const u32* y_offsets)
+	{
+		for (u32 y = 0; y < height; y++, dst += width)
+		{
+			const T* row = src + y_offsets[y];
+
+			for (u32 x = 0; x < width; x++)
+			{
+				dst[x] = row[x_offsets[x]];
+			}
+		}
+	}
+}
+
+RSXTextureConverter::RSXTextureConverter()
+	: m_arena_index(0)
+{
+}
+
+u8* RSXTextureConverter::Reserve(size_t size)
+{
+	m_arena_index ^= 1;
+
+	std::vector<u8>& arena = m_arena[m_arena_index];
+
+	if (arena.size() < size)
+	{
+		arena.resize(size);
+	}
+
+	return arena.data();
+}
+
+const u8* RSXTextureConverter::Unswizzle(const u8* src, u32 width, u32 height, u32 bpp)
+{
+	const u32 log2width = FloorLog2(width);
+	const u32 log2height = FloorLog2(height);
+
+	m_x_offsets.resize(width);
+	m_y_offsets.resize(height);
+
+	for (u32 x = 0; x < width; x++)
+	{
+		m_x_offsets[x] = LinearToSwizzleAddress(x, 0, 0, log2width, log2height, 0);
+	}
+
+	for (u32 y = 0; y < height; y++)
+	{
+		m_y_offsets[y] = LinearToSwizzleAddress(0, y, 0, log2width, log2height, 0);
+	}
+
+	u8* dst = Reserve(width * height * bpp);
+
+	switch (bpp)
+	{
+	case 1: UnswizzleTexels((u8*)dst, (const u8*)src, width, height, m_x_offsets.data(), m_y_offsets.data()); break;
+	case 2: UnswizzleTexels((u16*)dst, (const u16*)src, width, height, m_x_offsets.data(), m_y_offsets.data()); break;
+	case 4: UnswizzleTexels((u32*)dst, (const u32*)src, width, height, m_x_offsets.data(), m_y_offsets.data()); break;
+	case 8: UnswizzleTexels((u64*)dst, (const u64*)src, width, height, m_x_offsets.data(), m_y_offsets.data()); break;
+	case 16: UnswizzleTexels((u128_texel*)dst, (const u128_texel*)src, width, height, m_x_offsets.data(), m_y_offsets.data()); break;
+
+	default:
+		LOG_ERROR(RSX, "RSXTextureConverter::Unswizzle: unsupported texel size (%d)", bpp);
+		return src;
+	}
+
+	return dst;
+}
+
+const u8* RSXTextureConverter::ConvertR6G5B5(const u8* src, u32 width, u32 height)
+{
+	const u32 count = width * height;
+	u8* dst = Reserve(count * 4);
+
+	const __m128i mask6 = _mm_set1_epi16(0x3f);
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	const __m128i alpha = _mm_set1_epi16((s16)0xff00);
+
+	u32 i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + i * 2));
+		c = _mm_or_si128(_mm_slli_epi16(c, 8), _mm_srli_epi16(c, 8));
+
+		// expand with the same bit replication as GLTexture::Convert6To8/Convert5To8
+		const __m128i r = _mm_and_si128(_mm_srli_epi16(c, 10), mask6);
+		const __m128i g = _mm_and_si128(_mm_srli_epi16(c, 5), mask5);
+		const __m128i b = _mm_and_si128(c, mask5);
+		const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r, 2), _mm_srli_epi16(r, 4));
+		const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+		const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+		const __m128i rg = _mm_or_si128(r8, _mm_slli_epi16(g8, 8));
+		const __m128i ba = _mm_or_si128(b8, alpha);
+
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+
+	for (; i < count; i++)
+	{
+		const u16 c = src[i * 2] << 8 | src[i * 2 + 1];
+		const u8 r = (c >> 10) & 0x3f, g = (c >> 5) & 0x1f, b = c & 0x1f;
+		dst[i * 4 + 0] = (r << 2) | (r >> 4);
+		dst[i * 4 + 1] = (g << 3) | (g >> 2);
+		dst[i * 4 + 2] = (b << 3) | (b >> 2);
+		dst[i * 4 + 3] = 255;
+	}
+
+	return dst;
+}
+
+const u8* RSXTextureConverter::ConvertB8R8_G8R8(const u8* src, u32 width, u32 height)
+{
+	// 4 bytes (b, r1, g, r0) -> two RGBA pixels (r0, g, b, 255), (r1, g, b, 255)
+	const u32 count = width * height / 2;
+	u8* dst = Reserve(count * 8);
+
+	const __m128i mask = _mm_set1_epi32(0xff);
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	u32 i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		const __m128i gb = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 16), mask), 8), _mm_slli_epi32(_mm_and_si128(v, mask), 16));
+		const __m128i common = _mm_or_si128(gb, alpha);
+		const __m128i p0 = _mm_or_si128(common, _mm_srli_epi32(v, 24));
+		const __m128i p1 = _mm_or_si128(common, _mm_and_si128(_mm_srli_epi32(v, 8), mask));
+
+		_mm_storeu_si128((__m128i*)(dst + i * 8), _mm_unpacklo_epi32(p0, p1));
+		_mm_storeu_si128((__m128i*)(dst + i * 8 + 16), _mm_unpackhi_epi32(p0, p1));
+	}
+
+	for (; i < count; i++)
+	{
+		dst[i * 8 + 0] = src[i * 4 + 3];
+		dst[i * 8 + 1] = src[i * 4 + 2];
+		dst[i * 8 + 2] = src[i * 4 + 0];
+		dst[i * 8 + 3] = 255;
+		dst[i * 8 + 4] = src[i * 4 + 1];
+		dst[i * 8 + 5] = src[i * 4 + 2];
+		dst[i * 8 + 6] = src[i * 4 + 0];
+		dst[i * 8 + 7] = 255;
+	}
+
+	return dst;
+}
+
+const u8* RSXTextureConverter::ConvertR8B8_R8G8(const u8* src, u32 width, u32 height)
+{
+	// 4 bytes (r1, b, r0, g) -> two RGBA pixels (r0, g, b, 255), (r1, g, b, 255)
+	const u32 count = width * height / 2;
+	u8* dst = Reserve(count * 8);
+
+	const __m128i mask = _mm_set1_epi32(0xff);
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+	u32 i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		const __m128i gb = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(v, 24), 8), _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 8), mask), 16));
+		const __m128i common = _mm_or_si128(gb, alpha);
+		const __m128i p0 = _mm_or_si128(common, _mm_and_si128(_mm_srli_epi32(v, 16), mask));
+		const __m128i p1 = _mm_or_si128(common, _mm_and_si128(v, mask));
+
+		_mm_storeu_si128((__m128i*)(dst + i * 8), _mm_unpacklo_epi32(p0, p1));
+		_mm_storeu_si128((__m128i*)(dst + i * 8 + 16), _mm_unpackhi_epi32(p0, p1));
+	}
+
+	for (; i < count; i++)
+	{
+		dst[i * 8 + 0] = src[i * 4 + 2];
+		dst[i * 8 + 1] = src[i * 4 + 3];
+		dst[i * 8 + 2] = src[i * 4 + 1];
+		dst[i * 8 + 3] = 255;
+		dst[i * 8 + 4] = src[i * 4 + 0];
+		dst[i * 8 + 5] = src[i * 4 + 3];
+		dst[i * 8 + 6] = src[i * 4 + 1];
+		dst[i * 8 + 7] = 255;
+	}
+
+	return dst;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+u32 LinearToSwizzleAddress(u32 x, u32 y, u32 z, u32 log2_width, u32 log2_height, u32 log2_depth);
+
+// converts RSX texture data to layouts which can be uploaded directly
+// (the returned pointer stays valid until the second next call, so the result of one conversion can be passed to another one)
+class RSXTextureConverter
+{
+	std::vector<u8> m_arena[2]; // upload buffers, used alternately
+	u32 m_arena_index;
+	std::vector<u32> m_x_offsets; // swizzled offset of each column
+	std::vector<u32> m_y_offsets; // swizzled offset of each row
+
+	u8* Reserve(size_t size);
+
+public:
+	RSXTextureConverter();
+
+	// reorder swizzled (Morton order) texels of bpp bytes to rows
+	const u8* Unswizzle(const u8* src, u32 width, u32 height, u32 bpp);
+
+	// 16 bit big endian R6G5B5 to RGBA8
+	const u8* ConvertR6G5B5(const u8* src, u32 width, u32 height);
+
+	// two pixels sharing G and B in 32 bits to RGBA8
+	const u8* ConvertB8R8_G8R8(const u8* src, u32 width, u32 height);
+	const u8* ConvertR8B8_R8G8(const u8* src, u32 width, u32 height);
+};
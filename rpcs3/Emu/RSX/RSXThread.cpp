@@ -9,6 +9,7 @@
 #include "Emu/SysCalls/Callback.h"
 #include "Emu/SysCalls/CB_FUNC.h"
 #include "Emu/SysCalls/lv2/sys_time.h"
+#include "Emu/TimerManager.h"
 
 #define ARGS(x) (x >= count ? OutOfArgsCount(x, cmd, count, args.addr()) : args[x].value())
 #define CMD_DEBUG 0
@@ -112,44 +113,122 @@ void RSXVertexData::Reset()
 	data.clear();
 }
 
-void RSXVertexData::Load(u32 start, u32 count, u32 baseOffset, u32 baseIndex=0)
+namespace
 {
-	if (!addr) return;
+	// byte swapping of vertex components (SSE2, the build doesn't assume SSSE3)
+	template<typename T> struct VertexSwap;
 
-	const u32 tsize = GetTypeSize();
+	template<> struct VertexSwap<u8>
+	{
+		static u8 scalar(const u8 value) { return value; }
+		static __m128i vector(const __m128i value) { return value; }
+	};
 
-	data.resize((start + count) * tsize * size);
+	template<> struct VertexSwap<u16>
+	{
+		static u16 scalar(const u16 value) { return re16(value); }
+		static __m128i vector(const __m128i value) { return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8)); }
+	};
 
-	for (u32 i = start; i < start + count; ++i)
+	template<> struct VertexSwap<u32>
 	{
-		auto src = vm::get_ptr<const u8>(addr + baseOffset + stride * (i + baseIndex));
-		u8* dst = &data[i * tsize * size];
+		static u32 scalar(const u32 value) { return re32(value); }
 
-		switch(tsize)
+		static __m128i vector(const __m128i value)
 		{
-		case 1:
-		{
-			memcpy(dst, src, size); // may be dangerous
+			// swap 16 bit halves, then bytes
+			return VertexSwap<u16>::vector(_mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xb1), 0xb1));
 		}
-		break;
+	};
 
-		case 2:
+	// copy count vertices of N components of type T
+	template<typename T, u32 N>
+	void FetchVertices(u8* dst, const u8* src, const u32 stride, const u32 count)
+	{
+		const u32 item_size = sizeof(T) * N;
+
+		if (stride == item_size)
 		{
-			const u16* c_src = (const u16*)src;
-			u16* c_dst = (u16*)dst;
-			for (u32 j = 0; j < size; ++j) *c_dst++ = re16(*c_src++);
-		}
-		break;
+			// packed array: swap 16 bytes at once
+			const u32 size = item_size * count;
+			u32 i = 0;
 
-		case 4:
+			for (; i + 16 <= size; i += 16)
+			{
+				_mm_storeu_si128((__m128i*)(dst + i), VertexSwap<T>::vector(_mm_loadu_si128((const __m128i*)(src + i))));
+			}
+
+			for (; i < size; i += sizeof(T))
+			{
+				*(T*)(dst + i) = VertexSwap<T>::scalar(*(const T*)(src + i));
+			}
+		}
+		else if (item_size == 16)
 		{
-			const u32* c_src = (const u32*)src;
-			u32* c_dst = (u32*)dst;
-			for (u32 j = 0; j < size; ++j) *c_dst++ = re32(*c_src++);
+			for (u32 i = 0; i < count; i++, src += stride, dst += item_size)
+			{
+				_mm_storeu_si128((__m128i*)dst, VertexSwap<T>::vector(_mm_loadu_si128((const __m128i*)src)));
+			}
 		}
-		break;
+		else
+		{
+			for (u32 i = 0; i < count; i++, src += stride, dst += item_size)
+			{
+				for (u32 j = 0; j < N; j++)
+				{
+					((T*)dst)[j] = VertexSwap<T>::scalar(((const T*)src)[j]);
+				}
+			}
 		}
 	}
+
+	template<typename T>
+	void FetchVerticesAny(u8* dst, const u8* src, const u32 stride, const u32 count, const u32 size)
+	{
+		for (u32 i = 0; i < count; i++, src += stride, dst += sizeof(T) * size)
+		{
+			for (u32 j = 0; j < size; j++)
+			{
+				((T*)dst)[j] = VertexSwap<T>::scalar(((const T*)src)[j]);
+			}
+		}
+	}
+
+	typedef void(*vertex_fetch_func)(u8* dst, const u8* src, const u32 stride, const u32 count);
+
+	const vertex_fetch_func g_vertex_fetch[3][4] =
+	{
+		{ FetchVertices<u8, 1>, FetchVertices<u8, 2>, FetchVertices<u8, 3>, FetchVertices<u8, 4> },
+		{ FetchVertices<u16, 1>, FetchVertices<u16, 2>, FetchVertices<u16, 3>, FetchVertices<u16, 4> },
+		{ FetchVertices<u32, 1>, FetchVertices<u32, 2>, FetchVertices<u32, 3>, FetchVertices<u32, 4> },
+	};
+}
+
+void RSXVertexData::Load(u32 start, u32 count, u32 baseOffset, u32 baseIndex=0)
+{
+	if (!addr) return;
+
+	const u32 tsize = GetTypeSize();
+
+	data.resize((start + count) * tsize * size);
+
+	if (!count) return;
+
+	auto src = vm::get_ptr<const u8>(addr + baseOffset + stride * (start + baseIndex));
+	u8* dst = &data[start * tsize * size];
+
+	if (size >= 1 && size <= 4)
+	{
+		g_vertex_fetch[tsize == 4 ? 2 : tsize - 1][size - 1](dst, src, stride, count);
+		return;
+	}
+
+	switch (tsize)
+	{
+	case 1: FetchVerticesAny<u8>(dst, src, stride, count, size); break;
+	case 2: FetchVerticesAny<u16>(dst, src, stride, count, size); break;
+	case 4: FetchVerticesAny<u32>(dst, src, stride, count, size); break;
+	}
 }
 
 u32 RSXVertexData::GetTypeSize()
@@ -222,6 +301,8 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 	// NV406E
 	case NV406E_SET_REFERENCE:
 	{
+		// the guest may read the surfaces as soon as it sees the reference value (cellGcmFinish)
+		FlushSurfaces();
 		m_ctrl->ref.exchange(be_t<u32>::make(ARGS(0)));
 	}
 	break;
@@ -258,6 +339,9 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 		if (m_set_semaphore_offset)
 		{
 			m_set_semaphore_offset = false;
+
+			// the guest may read the surfaces as soon as it sees the semaphore value
+			FlushSurfaces();
 			vm::write32(Memory.RSXCMDMem.GetStartAddr() + m_semaphore_offset, ARGS(0));
 		}
 	}
@@ -271,6 +355,7 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 			u32 value = ARGS(0);
 			value = (value & 0xff00ff00) | ((value & 0xff) << 16) | ((value >> 16) & 0xff);
 
+			FlushSurfaces();
 			vm::write32(Memory.RSXCMDMem.GetStartAddr() + m_semaphore_offset, value);
 		}
 	}
@@ -311,7 +396,14 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 				return;
 			}
 
-			std::this_thread::sleep_for (std::chrono::milliseconds((s64)(1000.0 / limit - m_timer_sync.GetElapsedTimeInMilliSec())));
+			const u64 frame_time = (u64)(1000000.0 / limit);
+			const u64 elapsed = (u64)m_timer_sync.GetElapsedTimeInMicroSec();
+
+			if (elapsed < frame_time)
+			{
+				Emu.GetTimerManager().SleepUntil(get_system_time() + frame_time - elapsed);
+			}
+
 			m_timer_sync.Start();
 		};
 
@@ -1989,6 +2081,9 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 			LOG_ERROR(RSX, "NV0039_OFFSET_IN: Unsupported format: inFormat=%d, outFormat=%d", inFormat, outFormat);
 		}
 
+		// the source may be a rendered surface
+		FlushSurfaces();
+
 		if (lineCount == 1 && !inPitch && !outPitch && !notify)
 		{
 			memcpy(vm::get_ptr<void>(GetAddress(outOffset, 0)), vm::get_ptr<void>(GetAddress(inOffset, 0)), lineLength);
@@ -2158,6 +2253,9 @@ void RSXThread::DoCmd(const u32 fcmd, const u32 cmd, const u32 args_addr, const
 		u16 u = ARGS(3);
 		u16 v = ARGS(3) >> 16;
 
+		// the source may be a rendered surface
+		FlushSurfaces();
+
 		u8* pixels_src = vm::get_ptr<u8>(GetAddress(offset, m_context_dma_img_src - 0xfeed0000));
 		u8* pixels_dst = vm::get_ptr<u8>(GetAddress(m_dst_offset, m_context_dma_img_dst - 0xfeed0000));
 
@@ -2340,131 +2438,170 @@ void RSXThread::End()
 	OnReset();
 }
 
-void RSXThread::Task()
+u32 RSXThread::ParseFifo(u32 get, const u32 put)
 {
-	u8 inc;
-	LOG_NOTICE(RSX, "RSX thread started");
+	const bool logging = Ini.RSXLogging.GetValue();
 
-	OnInitThread();
-
-	m_last_flip_time = get_system_time() - 1000000;
+	m_fifo_batch.clear();
 
-	thread_t vblank("VBlank thread", true /* autojoin */, [this]()
+	for (uint i = 0; get != put && i < m_fifo_batch_max; i++)
 	{
-		const u64 start_time = get_system_time();
-
-		m_vblank_count = 0;
-
-		while (!TestDestroy() && !Emu.IsStopped())
-		{
-			if (get_system_time() - start_time > m_vblank_count * 1000000 / 60)
-			{
-				m_vblank_count++;
-				if (m_vblank_handler)
-				{
-					auto cb = m_vblank_handler;
-					Emu.GetCallbackManager().Async([cb](PPUThread& CPU)
-					{
-						cb(CPU, 1);
-					});
-				}
-				continue;
-			}
-
-			std::this_thread::sleep_for (std::chrono::milliseconds(1)); // hack
-		}
-	});
-
-	while (!TestDestroy()) try
-	{
-		if (Emu.IsStopped())
-		{
-			LOG_WARNING(RSX, "RSX thread aborted");
-			break;
-		}
-		std::lock_guard<std::mutex> lock(m_cs_main);
-
-		inc=1;
-
-		u32 get = m_ctrl->get.read_sync();
-		u32 put = m_ctrl->put.read_sync();
-
-		if (put == get || !Emu.IsRunning())
-		{
-			if (put == get)
-			{
-				if (m_flip_status == 0)
-					m_sem_flip.post_and_wait();
-
-				m_sem_flush.post_and_wait();
-			}
-
-			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-			continue;
-		}
-
 		const u32 cmd = ReadIO32(get);
 		const u32 count = (cmd >> 18) & 0x7ff;
-		
-		if (Ini.RSXLogging.GetValue())
+
+		if (logging)
 		{
 			LOG_NOTICE(Log::RSX, "%s (cmd=0x%x)", GetMethodName(cmd & 0xffff).c_str(), cmd);
 		}
 
 		if (cmd & CELL_GCM_METHOD_FLAG_JUMP)
 		{
-			u32 offs = cmd & 0x1fffffff;
-			//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
-			m_ctrl->get.exchange(be_t<u32>::make(offs));
+			//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", cmd & 0x1fffffff, m_ioAddress + get, cmd, get, put);
+			get = cmd & 0x1fffffff;
 			continue;
 		}
 
 		if (cmd & CELL_GCM_METHOD_FLAG_CALL)
 		{
+			//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", cmd & ~3, cmd, get);
 			m_call_stack.push(get + 4);
-			u32 offs = cmd & ~3;
-			//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", offs, cmd, get);
-			m_ctrl->get.exchange(be_t<u32>::make(offs));
+			get = cmd & ~3;
 			continue;
 		}
 
 		if (cmd == CELL_GCM_METHOD_FLAG_RETURN)
 		{
-			u32 get = m_call_stack.top();
+			get = m_call_stack.top();
 			m_call_stack.pop();
 			//LOG_WARNING(RSX, "rsx return(0x%x)", get);
-			m_ctrl->get.exchange(be_t<u32>::make(get));
 			continue;
 		}
 
+		if (cmd == 0) //nop
+		{
+			get += 4;
+			continue;
+		}
+
+		m_fifo_batch.push_back({ cmd, (u32)Memory.RSXIOMem.RealAddr(get + 4), count });
+
+		get += (count + 1) * 4;
+	}
+
+	return get;
+}
+
+void RSXThread::ExecuteFifoBatch()
+{
+	for (auto& command : m_fifo_batch)
+	{
+		const u32 cmd = command.cmd;
+		const u32 count = command.count;
+		const u32 reg = cmd & 0xffff;
+		auto args = vm::ptr<u32>::make(command.args_addr);
+
 		if (cmd & CELL_GCM_METHOD_FLAG_NON_INCREMENT)
 		{
 			//LOG_WARNING(RSX, "rsx non increment cmd! 0x%x", cmd);
-			inc = 0;
+			if (count)
+			{
+				methodRegisters[reg] = args[count - 1];
+			}
+		}
+		else
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				methodRegisters[reg + i * 4] = args[i];
+			}
 		}
 
-		if (cmd == 0) //nop
+		DoCmd(cmd, cmd & 0x3ffff, command.args_addr, count);
+	}
+}
+
+void RSXThread::Task()
+{
+	LOG_NOTICE(RSX, "RSX thread started");
+
+	OnInitThread();
+
+	m_last_flip_time = get_system_time() - 1000000;
+
+	m_vblank_count = 0;
+
+	// 60 Hz (the period is rounded to whole microseconds)
+	const u64 vblank_period = (1000000 + 30) / 60;
+
+	const u32 vblank_timer = Emu.GetTimerManager().Add(get_system_time() + vblank_period, vblank_period, [this](u64)
+	{
+		m_vblank_count++;
+		if (m_vblank_handler)
 		{
-			m_ctrl->get.atomic_op([](be_t<u32>& value)
+			auto cb = m_vblank_handler;
+			Emu.GetCallbackManager().Async([cb](PPUThread& CPU)
 			{
-				value += 4;
+				cb(CPU, 1);
 			});
-			continue;
 		}
+	});
 
-		auto args = vm::ptr<u32>::make((u32)Memory.RSXIOMem.RealAddr(get + 4));
-
-		for (u32 i = 0; i < count; i++)
+	while (!TestDestroy()) try
+	{
+		if (Emu.IsStopped())
 		{
-			methodRegisters[(cmd & 0xffff) + (i * 4 * inc)] = ARGS(i);
+			LOG_WARNING(RSX, "RSX thread aborted");
+			break;
 		}
 
-		DoCmd(cmd, cmd & 0x3ffff, args.addr(), count);
+		bool idle = false;
 
-		m_ctrl->get.atomic_op([count](be_t<u32>& value)
 		{
-			value += (count + 1) * 4;
-		});
+			std::lock_guard<std::mutex> lock(m_cs_main);
+
+			const u32 get = m_ctrl->get.read_sync();
+			const u32 put = m_ctrl->put.read_sync();
+
+			if (put == get || !Emu.IsRunning())
+			{
+				if (put == get)
+				{
+					if (m_flip_status == 0)
+						m_sem_flip.post_and_wait();
+
+					m_sem_flush.post_and_wait();
+				}
+
+				idle = true;
+			}
+			else
+			{
+				// put is read once, the commands are decoded and executed before get is updated
+				const u32 next = ParseFifo(get, put);
+
+				ExecuteFifoBatch();
+
+				m_ctrl->get.exchange(be_t<u32>::make(next));
+			}
+		}
+
+		if (idle)
+		{
+			// HLE functions updating put wake the thread up, but the game can also write put directly
+			// (the control register isn't write-trapped), so it's watched for a short time before sleeping
+			const u64 poll_until = get_system_time() + 100;
+
+			while (m_ctrl->put.read_relaxed() == m_ctrl->get.read_relaxed())
+			{
+				if (!Emu.IsRunning() || get_system_time() >= poll_until)
+				{
+					WaitForAnySignal(1);
+					break;
+				}
+
+				std::this_thread::yield();
+			}
+		}
 	}
 	catch (const std::string& e)
 	{
@@ -2477,6 +2614,8 @@ void RSXThread::Task()
 		Emu.Pause();
 	}
 
+	Emu.GetTimerManager().Remove(vblank_timer);
+
 	LOG_NOTICE(RSX, "RSX thread ended");
 
 	OnExitThread();
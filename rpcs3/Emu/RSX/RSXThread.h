@@ -99,8 +99,20 @@ public:
 	static const uint m_tiles_count = 15;
 	static const uint m_zculls_count = 8;
 
+	// max count of method packets decoded at once (get is published after each batch)
+	static const uint m_fifo_batch_max = 0x400;
+
 protected:
+	// method packet decoded by the FIFO front end
+	struct RSXCommand
+	{
+		u32 cmd;
+		u32 args_addr;
+		u32 count;
+	};
+
 	std::stack<u32> m_call_stack;
+	std::vector<RSXCommand> m_fifo_batch;
 	CellGcmControl* m_ctrl;
 	Timer m_timer_sync;
 	double m_fps_limit = 59.94;
@@ -670,6 +682,7 @@ protected:
 	virtual void StencilMaskSeparate(u32 mode, u32 mask) = 0;
 	virtual void StencilFuncSeparate(u32 mode, u32 func, u32 ref, u32 mask) = 0;
 	virtual void Flip() = 0;
+	virtual void FlushSurfaces() = 0; // write rendered surfaces which are still pending to guest memory
 
 	void LoadVertexData(u32 first, u32 count)
 	{
@@ -681,6 +694,10 @@ protected:
 		}
 	}
 
+	// decode method packets between get and put into m_fifo_batch (following jumps and calls), returns the new get
+	u32 ParseFifo(u32 get, const u32 put);
+	void ExecuteFifoBatch();
+
 	virtual void Task();
 
 public:
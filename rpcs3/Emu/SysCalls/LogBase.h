@@ -1,4 +1,5 @@
 #pragma once
+#include "Utilities/Log.h"
 
 class LogBase
 {
@@ -14,12 +15,26 @@ class LogBase
 		LogTodo,
 	};
 
-	void LogOutput(LogType type, const std::string& text) const;
-
 	template<typename... Targs>
-	__noinline void LogPrepare(LogType type, const char* fmt, size_t len, Targs... args) const
+	__noinline void LogPrepare(LogType type, const char* fmt, Targs... args) const
 	{
-		LogOutput(type, fmt::detail::format(fmt, len, args...));
+		Log::LogSeverity sev;
+		const char* tag = ": ";
+
+		switch (type)
+		{
+		case LogNotice: sev = Log::Notice; break;
+		case LogSuccess: sev = Log::Success; break;
+		case LogWarning: sev = Log::Warning; break;
+		case LogError: sev = Log::Error; tag = " error: "; break;
+		default: sev = Log::Error; tag = " TODO: "; break;
+		}
+
+		// the message is formatted by the log writer thread
+		if (sev >= Log::MinSeverity && Log::check_log(Log::HLE, sev))
+		{
+			Log::log_record_prefixed(Log::HLE, sev, GetName().c_str(), tag, fmt, args...);
+		}
 	}
 
 public:
@@ -38,7 +53,7 @@ public:
 	template<typename... Targs>
 	__forceinline void Notice(const char* fmt, Targs... args) const
 	{
-		LogPrepare(LogNotice, fmt, strlen(fmt), fmt::do_unveil(args)...);
+		LogPrepare(LogNotice, fmt, fmt::do_unveil(args)...);
 	}
 
 	template<typename... Targs>
@@ -53,25 +68,25 @@ public:
 	template<typename... Targs>
 	__forceinline void Success(const char* fmt, Targs... args) const
 	{
-		LogPrepare(LogSuccess, fmt, strlen(fmt), fmt::do_unveil(args)...);
+		LogPrepare(LogSuccess, fmt, fmt::do_unveil(args)...);
 	}
 
 	template<typename... Targs>
 	__forceinline void Warning(const char* fmt, Targs... args) const
 	{
-		LogPrepare(LogWarning, fmt, strlen(fmt), fmt::do_unveil(args)...);
+		LogPrepare(LogWarning, fmt, fmt::do_unveil(args)...);
 	}
 
 	template<typename... Targs>
 	__forceinline void Error(const char* fmt, Targs... args) const
 	{
-		LogPrepare(LogError, fmt, strlen(fmt), fmt::do_unveil(args)...);
+		LogPrepare(LogError, fmt, fmt::do_unveil(args)...);
 	}
 
 	template<typename... Targs>
 	__forceinline void Todo(const char* fmt, Targs... args) const
 	{
-		LogPrepare(LogTodo, fmt, strlen(fmt), fmt::do_unveil(args)...);
+		LogPrepare(LogTodo, fmt, fmt::do_unveil(args)...);
 	}
 };
 
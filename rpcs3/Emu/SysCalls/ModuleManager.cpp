@@ -1,4 +1,7 @@
 #include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Ini.h"
+#include "Emu/SysCalls/SysCalls.h"
 #include "ModuleManager.h"
 
 extern void cellAdec_init(Module* pxThis);
@@ -206,66 +209,101 @@ void ModuleManager::init()
 	}
 }
 
-ModuleManager::ModuleManager() :
-m_max_module_id(0),
-m_module_2_count(0),
-initialized(false)
+// marks a removed entry, lookups continue probing past it
+static ModuleFunc* const g_removed_func = reinterpret_cast<ModuleFunc*>(static_cast<uintptr_t>(1));
+
+static inline u32 hash_func_id(u32 id)
 {
-	memset(m_modules, 0, 3 * 0xFF * sizeof(Module*));
+	// NIDs are already hashes, just mix upper bits in
+	return id ^ (id >> 16);
 }
 
-ModuleManager::~ModuleManager()
+ModuleManager::func_index_t::func_index_t(u32 size)
+	: mask(size - 1)
+	, count(0)
+	, removed(0)
+	, slots(new std::atomic<ModuleFunc*>[size])
 {
-	UnloadModules();
+	assert(size && !(size & (size - 1)));
+
+	for (u32 i = 0; i < size; i++)
+	{
+		slots[i].store(nullptr, std::memory_order_relaxed);
+	}
 }
 
-bool ModuleManager::IsLoadedFunc(u32 id) const
+ModuleFunc* ModuleManager::func_index_t::find(u32 id) const
 {
-	for (u32 i = 0; i<m_modules_funcs_list.size(); ++i)
+	for (u32 i = hash_func_id(id) & mask, n = 0; n <= mask; i = (i + 1) & mask, n++)
 	{
-		if (m_modules_funcs_list[i]->id == id)
+		ModuleFunc* func = slots[i].load(std::memory_order_acquire);
+
+		if (!func)
 		{
-			return true;
+			break;
+		}
+
+		if (func != g_removed_func && func->id == id)
+		{
+			return func;
 		}
 	}
 
-	return false;
+	return nullptr;
 }
 
-bool ModuleManager::CallFunc(PPUThread& CPU, u32 num)
+bool ModuleManager::func_index_t::insert(ModuleFunc* func)
 {
-	func_caller* func = nullptr;
+	// the function must not be in the table already
+	u32 pos = ~0;
+
+	for (u32 i = hash_func_id(func->id) & mask;; i = (i + 1) & mask)
 	{
-		std::lock_guard<std::mutex> lock(m_funcs_lock);
+		ModuleFunc* f = slots[i].load(std::memory_order_relaxed);
 
-		for (u32 i = 0; i<m_modules_funcs_list.size(); ++i)
+		if (f == g_removed_func)
 		{
-			if (m_modules_funcs_list[i]->id == num)
-			{
-				func = m_modules_funcs_list[i]->func;
-				break;
-			}
+			// reuse the first removed entry of the chain (readers probing past it are unaffected)
+			slots[i].store(func, std::memory_order_release);
+			removed--;
+			count++;
+			return true;
+		}
+
+		if (!f)
+		{
+			pos = i;
+			break;
 		}
 	}
 
-	if (func)
+	// keep load factor <= 1/2 (removed entries are counted too)
+	if ((count + removed + 1) * 2 > mask + 1)
 	{
-		(*func)(CPU);
-		return true;
+		return false;
 	}
-	return false;
+
+	slots[pos].store(func, std::memory_order_release);
+	count++;
+	return true;
 }
 
-bool ModuleManager::UnloadFunc(u32 id)
+bool ModuleManager::func_index_t::remove(u32 id)
 {
-	std::lock_guard<std::mutex> lock(m_funcs_lock);
-
-	for (u32 i = 0; i<m_modules_funcs_list.size(); ++i)
+	for (u32 i = hash_func_id(id) & mask, n = 0; n <= mask; i = (i + 1) & mask, n++)
 	{
-		if (m_modules_funcs_list[i]->id == id)
+		ModuleFunc* func = slots[i].load(std::memory_order_relaxed);
+
+		if (!func)
 		{
-			m_modules_funcs_list.erase(m_modules_funcs_list.begin() + i);
+			break;
+		}
 
+		if (func != g_removed_func && func->id == id)
+		{
+			slots[i].store(g_removed_func, std::memory_order_release);
+			count--;
+			removed++;
 			return true;
 		}
 	}
@@ -273,14 +311,104 @@ bool ModuleManager::UnloadFunc(u32 id)
 	return false;
 }
 
+ModuleManager::ModuleManager() :
+m_max_module_id(0),
+m_module_2_count(0),
+m_funcs_index(nullptr),
+initialized(false)
+{
+	memset(m_modules, 0, 3 * 0xFF * sizeof(Module*));
+	ResetFuncIndex();
+}
+
+ModuleManager::~ModuleManager()
+{
+	UnloadModules();
+}
+
+void ModuleManager::ResetFuncIndex()
+{
+	// must be called with m_funcs_lock held (or when no other thread can access the index)
+	m_funcs_indices.clear();
+	m_funcs_indices.emplace_back(new func_index_t(0x1000));
+	m_funcs_index.store(m_funcs_indices.back().get(), std::memory_order_release);
+}
+
+bool ModuleManager::IsLoadedFunc(u32 id) const
+{
+	return m_funcs_index.load(std::memory_order_acquire)->find(id) != nullptr;
+}
+
+bool ModuleManager::CallFunc(PPUThread& CPU, u32 num)
+{
+	ModuleFunc* func = m_funcs_index.load(std::memory_order_acquire)->find(num);
+
+	if (func && func->func)
+	{
+		func->calls.fetch_add(1, std::memory_order_relaxed);
+		(*func->func)(CPU);
+		return true;
+	}
+	return false;
+}
+
+bool ModuleManager::UnloadFunc(u32 id)
+{
+	std::lock_guard<std::mutex> lock(m_funcs_lock);
+
+	return m_funcs_index.load(std::memory_order_relaxed)->remove(id);
+}
+
 u32 ModuleManager::GetFuncNumById(u32 id)
 {
 	return id;
 }
 
+u64 ModuleManager::GetFuncCallCount(u32 id) const
+{
+	ModuleFunc* func = m_funcs_index.load(std::memory_order_acquire)->find(id);
+
+	return func ? func->calls.load(std::memory_order_relaxed) : 0;
+}
+
+void ModuleManager::LogHotFuncs(u32 max_count)
+{
+	std::vector<ModuleFunc*> funcs;
+	{
+		std::lock_guard<std::mutex> lock(m_funcs_lock);
+
+		const func_index_t& index = *m_funcs_index.load(std::memory_order_relaxed);
+
+		for (u32 i = 0; i <= index.mask; i++)
+		{
+			ModuleFunc* func = index.slots[i].load(std::memory_order_relaxed);
+
+			if (func && func != g_removed_func && func->calls.load(std::memory_order_relaxed))
+			{
+				funcs.push_back(func);
+			}
+		}
+	}
+
+	std::sort(funcs.begin(), funcs.end(), [](ModuleFunc* a, ModuleFunc* b)
+	{
+		return a->calls.load(std::memory_order_relaxed) > b->calls.load(std::memory_order_relaxed);
+	});
+
+	for (u32 i = 0; i < funcs.size() && i < max_count; i++)
+	{
+		LOG_NOTICE(HLE, "HLE calls: %s: %lld", SysCalls::GetHLEFuncName(funcs[i]->id).c_str(), funcs[i]->calls.load(std::memory_order_relaxed));
+	}
+}
+
 //to load the default modules after calling this call Init() again
 void ModuleManager::UnloadModules()
 {
+	if (Ini.HLELogging.GetValue())
+	{
+		LogHotFuncs(20);
+	}
+
 	for (u32 i = 0; i<3; ++i)
 	{
 		for (u32 j = 0; j<m_max_module_id; ++j)
@@ -292,6 +420,12 @@ void ModuleManager::UnloadModules()
 		}
 	}
 
+	{
+		// drop all references to ModuleFunc(s) before their owners are destroyed
+		std::lock_guard<std::mutex> lock(m_funcs_lock);
+		ResetFuncIndex();
+	}
+
 	//reset state of the module manager
 	//this could be done by calling the destructor and then a placement-new
 	//to avoid repeating the initial values here but the defaults aren't
@@ -301,9 +435,6 @@ void ModuleManager::UnloadModules()
 	m_module_2_count = 0;
 	initialized = false;
 	memset(m_modules, 0, 3 * 0xFF * sizeof(Module*));
-	
-	std::lock_guard<std::mutex> lock(m_funcs_lock);
-	m_modules_funcs_list.clear();
 }
 
 Module* ModuleManager::GetModuleByName(const std::string& name)
@@ -395,8 +526,32 @@ void ModuleManager::AddFunc(ModuleFunc *func)
 {
 	std::lock_guard<std::mutex> guard(m_funcs_lock);
 
-	if (!IsLoadedFunc(func->id))
+	func_index_t* index = m_funcs_index.load(std::memory_order_relaxed);
+
+	if (index->find(func->id))
 	{
-		m_modules_funcs_list.push_back(func);
+		return;
+	}
+
+	if (!index->insert(func))
+	{
+		// rebuild the table without removed entries, old tables are kept alive for concurrent readers
+		// (it's only made bigger if the loaded functions themselves fill more than a quarter of it)
+		const u32 size = (index->count + 1) * 4 > index->mask + 1 ? (index->mask + 1) * 2 : index->mask + 1;
+		std::unique_ptr<func_index_t> new_index(new func_index_t(size));
+
+		for (u32 i = 0; i <= index->mask; i++)
+		{
+			ModuleFunc* f = index->slots[i].load(std::memory_order_relaxed);
+
+			if (f && f != g_removed_func)
+			{
+				new_index->insert(f);
+			}
+		}
+
+		new_index->insert(func);
+		m_funcs_indices.push_back(std::move(new_index));
+		m_funcs_index.store(m_funcs_indices.back().get(), std::memory_order_release);
 	}
-}
\ No newline at end of file
+}
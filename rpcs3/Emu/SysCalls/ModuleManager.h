@@ -3,14 +3,32 @@
 
 class ModuleManager
 {
+	// open addressing table (NID -> loaded function), readers never lock it
+	struct func_index_t
+	{
+		const u32 mask; // size - 1
+		u32 count; // loaded functions
+		u32 removed; // slots holding removed entries
+		std::unique_ptr<std::atomic<ModuleFunc*>[]> slots;
+
+		func_index_t(u32 size);
+
+		ModuleFunc* find(u32 id) const;
+		bool insert(ModuleFunc* func);
+		bool remove(u32 id);
+	};
+
 	Module* m_modules[3][0xff];//keep pointer to modules split in 3 categories according to their id
 	uint m_max_module_id; //max index in m_modules[2][], m_modules[1][] and m_modules[0][]
 	uint m_module_2_count; //max index in m_modules[2][]
-	std::mutex m_funcs_lock;
-	std::vector<ModuleFunc *> m_modules_funcs_list;
+	std::mutex m_funcs_lock; // protects writers of m_funcs_index
+	std::atomic<func_index_t*> m_funcs_index; // current table
+	std::vector<std::unique_ptr<func_index_t>> m_funcs_indices; // all tables created (the old ones may still be read)
 	std::vector<Module> m_mod_init; //owner of Module
 	bool initialized;
 
+	void ResetFuncIndex();
+
 public:
 	ModuleManager();
 	~ModuleManager();
@@ -23,6 +41,8 @@ public:
 	bool UnloadFunc(u32 id);
 	void UnloadModules();
 	u32 GetFuncNumById(u32 id);
+	u64 GetFuncCallCount(u32 id) const;
+	void LogHotFuncs(u32 max_count);
 	Module* GetModuleByName(const std::string& name);
 	Module* GetModuleById(u16 id);
 };
\ No newline at end of file
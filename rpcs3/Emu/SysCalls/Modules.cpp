@@ -155,12 +155,7 @@ void Module::SetName(const std::string& name)
 
 bool Module::CheckID(u32 id) const
 {
-	return Emu.GetIdManager().CheckID(id) && Emu.GetIdManager().GetID(id).GetName() == GetName();
-}
-
-bool Module::CheckID(u32 id, ID*& _id) const
-{
-	return Emu.GetIdManager().CheckID(id) && (_id = &Emu.GetIdManager().GetID(id))->GetName() == GetName();
+	return Emu.GetIdManager().CheckID(id, GetName());
 }
 
 bool Module::RemoveId(u32 id)
@@ -10,11 +10,13 @@ struct ModuleFunc
 	u32 id;
 	func_caller* func;
 	vm::ptr<void(*)()> lle_func;
+	std::atomic<u64> calls; // HLE call counter
 
 	ModuleFunc(u32 id, func_caller* func, vm::ptr<void(*)()> lle_func = vm::ptr<void(*)()>::make(0))
 		: id(id)
 		, func(func)
 		, lle_func(lle_func)
+		, calls(0)
 	{
 	}
 
@@ -98,29 +100,14 @@ public:
 
 	template<typename T> bool CheckId(u32 id, std::shared_ptr<T>& data)
 	{
-		ID* id_data;
-
-		if(!CheckID(id, id_data)) return false;
-
-		data = id_data->GetData()->get<T>();
-
-		return true;
+		return GetIdManager().GetIDData(id, data, GetName());
 	}
 
 	template<typename T> bool CheckId(u32 id, std::shared_ptr<T>& data, IDType& type)
 	{
-		ID* id_data;
-
-		if(!CheckID(id, id_data)) return false;
-
-		data = id_data->GetData()->get<T>();
-		type = id_data->GetType();
-
-		return true;
+		return GetIdManager().GetIDData(id, data, GetName(), &type);
 	}
 
-	bool CheckID(u32 id, ID*& _id) const;
-
 	template<typename T>
 	u32 GetNewId(std::shared_ptr<T>& data, IDType type = TYPE_OTHER)
 	{
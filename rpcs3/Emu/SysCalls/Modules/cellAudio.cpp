@@ -10,6 +10,7 @@
 #include "Emu/SysCalls/lv2/sys_time.h"
 #include "Emu/SysCalls/lv2/sys_event.h"
 #include "Emu/Event.h"
+#include "Emu/TimerManager.h"
 #include "Emu/Audio/AudioManager.h"
 #include "Emu/Audio/AudioDumper.h"
 
@@ -169,7 +170,7 @@ s32 cellAudioInit()
 			const u64 expected_time = g_audio.counter * AUDIO_SAMPLES * MHZ / 48000;
 			if (expected_time >= stamp0 - g_audio.start_time)
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				Emu.GetTimerManager().SleepUntil(g_audio.start_time + expected_time + 1);
 				continue;
 			}
 			
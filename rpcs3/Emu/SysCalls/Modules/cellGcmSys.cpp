@@ -530,6 +530,8 @@ s32 cellGcmSetPrepareFlip(vm::ptr<CellGcmContextData> ctxt, u32 id)
 		{
 			value += 8;
 		});
+
+		Emu.GetGSManager().GetRender().Notify();
 	}
 
 	return id;
@@ -986,7 +988,7 @@ s32 cellGcmUnmapEaIoAddress(u64 ea)
 		ea = ea >> 20;
 		io = offsetTable.ioAddress[ea];
 
-		for (u32 i = 0; i<size; i++)
+		for (u32 i = 0; i<(size >> 20); i++)
 		{
 			offsetTable.ioAddress[ea + i] = 0xFFFF;
 			offsetTable.eaAddress[io + i] = 0xFFFF;
@@ -1012,7 +1014,7 @@ s32 cellGcmUnmapIoAddress(u64 io)
 		io = io >> 20;
 		ea = offsetTable.eaAddress[io];
 
-		for (u32 i = 0; i<size; i++)
+		for (u32 i = 0; i<(size >> 20); i++)
 		{
 			offsetTable.ioAddress[ea + i] = 0xFFFF;
 			offsetTable.eaAddress[io + i] = 0xFFFF;
@@ -1184,6 +1186,7 @@ s32 cellGcmCallback(vm::ptr<CellGcmContextData> context, u32 count)
 		context->current = context->begin + res;
 		ctrl.put.write_relaxed(res);
 		ctrl.get.write_relaxed(be_t<u32>::make(0));
+		Emu.GetGSManager().GetRender().Notify();
 
 		return CELL_OK;
 	}
@@ -1208,6 +1211,7 @@ s32 cellGcmCallback(vm::ptr<CellGcmContextData> context, u32 count)
 
 		auto& ctrl = vm::get_ref<CellGcmControl>(gcm_info.control_addr);
 		ctrl.put.write_relaxed(be_t<u32>::make(offset));
+		Emu.GetGSManager().GetRender().Notify();
 	}
 	else
 	{
@@ -458,6 +458,7 @@ s64 spursInit(
 				{
 					// load executable code:
 					memcpy(vm::get_ptr<void>(SPU.ls_offset + 0xa00), wkl.pm.get_ptr(), wkl.size);
+					SPU.MarkLSDirty(0xa00, wkl.size);
 					SPU.WriteLS64(0x1d0, wkl.pm.addr());
 					SPU.WriteLS32(0x1d8, wkl.copy.read_relaxed());
 				}
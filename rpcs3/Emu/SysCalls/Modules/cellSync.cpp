@@ -4,6 +4,7 @@
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/SysCalls/CB_FUNC.h"
 #include "Emu/Memory/atomic_type.h"
+#include "Emu/CPU/CPUThreadManager.h"
 
 #include "Emu/SysCalls/lv2/sleep_queue_type.h"
 #include "Emu/SysCalls/lv2/sys_event.h"
@@ -1339,7 +1340,7 @@ s32 _cellSyncLFQueuePushBody(PPUThread& CPU, vm::ptr<CellSyncLFQueue> queue, vm:
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		PPUSchedulerSleep(1); // hack
 		if (Emu.IsStopped())
 		{
 			cellSync->Warning("_cellSyncLFQueuePushBody(queue_addr=0x%x) aborted", queue.addr());
@@ -1715,7 +1716,7 @@ s32 _cellSyncLFQueuePopBody(PPUThread& CPU, vm::ptr<CellSyncLFQueue> queue, vm::
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		PPUSchedulerSleep(1); // hack
 		if (Emu.IsStopped())
 		{
 			cellSync->Warning("_cellSyncLFQueuePopBody(queue_addr=0x%x) aborted", queue.addr());
@@ -34,14 +34,6 @@
 
 #include "SysCalls.h"
 
-namespace detail
-{
-	bool CheckIdID(u32 id, ID*& _id, const std::string &name)
-	{
-		return Emu.GetIdManager().CheckID(id) && (_id = &Emu.GetIdManager().GetID(id))->GetName() == name;
-	}
-}
-
 void default_syscall(PPUThread& CPU);
 static func_caller *null_func = bind_func(default_syscall);
 
@@ -7,19 +7,6 @@
 
 class SysCallBase;
 
-namespace detail
-{
-	bool CheckIdID(u32 id, ID*& _id, const std::string& name);
-
-	template<typename T> bool CheckId(u32 id, std::shared_ptr<T>& data, const std::string& name)
-	{
-		ID* id_data;
-		if(!CheckIdID(id, id_data, name)) return false;
-		data = id_data->GetData()->get<T>();
-		return true;
-	}
-}
-
 class SysCallBase : public LogBase
 {
 private:
@@ -41,13 +28,13 @@ public:
 
 	bool CheckId(u32 id) const
 	{
-		return GetIdManager().CheckID(id) && GetIdManager().GetID(id).GetName() == GetName();
+		return GetIdManager().CheckID(id, GetName());
 	}
 
 	template<typename T>
 	bool CheckId(u32 id, std::shared_ptr<T>& data) const
 	{
-		return detail::CheckId(id, data, GetName());
+		return GetIdManager().GetIDData(id, data, GetName());
 	}
 
 	template<typename T>
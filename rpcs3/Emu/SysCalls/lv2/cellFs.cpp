@@ -882,69 +882,179 @@ s32 cellFsSdataOpenByFd(u32 mself_fd, s32 flags, vm::ptr<u32> sdata_fd, u64 offs
 	return CELL_OK;
 }
 
-std::atomic<s32> g_FsAioReadID(0);
-std::atomic<s32> g_FsAioReadCur(0);
+typedef vm::ptr<void(*)(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)> fs_aio_cb_t;
+
+struct FsAioRequest
+{
+	u32 fd;
+	vm::ptr<CellFsAio> aio;
+	s32 xid;
+	fs_aio_cb_t func;
+	bool write;
+};
+
+const u32 g_FsAioWorkerCount = 4;
+const u32 g_FsAioMaxBatch = 16; // max requests for one file taken by a worker at once
+
+std::mutex g_FsAioMutex;
+std::condition_variable g_FsAioCond;
+std::vector<FsAioRequest> g_FsAioQueue; // pending requests in submission order
+std::set<u32> g_FsAioBusy; // fds being processed by a worker (requests for the same file complete in order)
+u32 g_FsAioGeneration = 0; // incremented when the module is reloaded, workers of the old generation exit
+u32 g_FsAioWorkers = 0; // workers started in the current generation
+std::atomic<s32> g_FsAioID(0);
 bool aio_init = false;
 
-void fsAioRead(u32 fd, vm::ptr<CellFsAio> aio, int xid, vm::ptr<void(*)(vm::ptr<CellFsAio> xaio, int error, int xid, u64 size)> func)
+void fsAioComplete(const FsAioRequest& req, u32 error, u64 res)
 {
-	while (g_FsAioReadCur != xid)
+	sys_fs->Log("*** fsAio%s(fd=%d, offset=0x%llx, buf=0x%x, size=0x%llx, error=0x%x, res=0x%llx, xid=0x%x)",
+		req.write ? "Write" : "Read", req.fd, req.aio->offset, req.aio->buf, req.aio->size, error, res, req.xid);
+
+	if (const auto func = req.func)
 	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-		if (Emu.IsStopped())
+		const auto aio = req.aio;
+		const s32 xid = req.xid;
+
+		Emu.GetCallbackManager().Async([func, aio, error, xid, res](PPUThread& CPU)
 		{
-			sys_fs->Warning("fsAioRead() aborted");
-			return;
-		}
+			func(CPU, aio, error, xid, res);
+		});
 	}
+}
 
-	u32 error = CELL_OK;
-	u64 res = 0;
+void fsAioProcess(const std::vector<FsAioRequest>& batch)
+{
+	// all requests in the batch belong to the same fd
+	std::shared_ptr<vfsStream> file;
+	if (!sys_fs->CheckId(batch[0].fd, file))
 	{
-		std::shared_ptr<vfsStream> orig_file;
-		if (!sys_fs->CheckId(fd, orig_file))
+		for (auto& req : batch)
 		{
-			sys_fs->Error("Wrong fd (%s)", fd);
-			Emu.Pause();
-			return;
+			fsAioComplete(req, CELL_EBADF, 0);
 		}
+		return;
+	}
 
-		u64 nbytes = aio->size;
+	for (size_t i = 0; i < batch.size();)
+	{
+		const FsAioRequest& req = batch[i];
+		const u64 offset = req.aio->offset;
+		const u64 size = req.aio->size;
+		const u32 buf = req.aio->buf.addr();
 
-		vfsStream& file = *orig_file;
-		const u64 old_pos = file.Tell();
-		file.Seek((u64)aio->offset);
+		if (size != (u32)size)
+		{
+			fsAioComplete(req, CELL_ENOMEM, 0);
+			i++;
+			continue;
+		}
 
-		if (nbytes != (u32)nbytes)
+		if (req.write)
 		{
-			error = CELL_ENOMEM;
+			fsAioComplete(req, CELL_OK, size ? file->WriteAt(offset, vm::get_ptr<void>(buf), size) : 0);
+			i++;
+			continue;
 		}
-		else
+
+		// merge following reads which continue both in the file and in guest memory
+		size_t count = 1;
+		u64 total = size;
+
+		while (i + count < batch.size() && total < 0x1000000)
 		{
-			res = nbytes ? file.Read(aio->buf.get_ptr(), nbytes) : 0;
+			const FsAioRequest& next = batch[i + count];
+
+			if (next.write || next.aio->offset != offset + total || next.aio->buf.addr() != buf + total || next.aio->size != (u32)next.aio->size)
+			{
+				break;
+			}
+
+			total += next.aio->size;
+			count++;
 		}
 
-		file.Seek(old_pos);
+		u64 res = total ? file->ReadAt(offset, vm::get_ptr<void>(buf), total) : 0;
 
-		sys_fs->Log("*** fsAioRead(fd=%d, offset=0x%llx, buf=0x%x, size=0x%llx, error=0x%x, res=0x%llx, xid=0x%x)",
-			fd, aio->offset, aio->buf, aio->size, error, res, xid);
+		for (size_t j = i; j < i + count; j++)
+		{
+			const u64 part = std::min<u64>(batch[j].aio->size, res);
+			res -= part;
+			fsAioComplete(batch[j], CELL_OK, part);
+		}
+
+		i += count;
 	}
+}
 
-	if (func)
+void fsAioWorker(u32 generation)
+{
+	std::vector<FsAioRequest> batch;
+
+	while (true)
 	{
-		Emu.GetCallbackManager().Async([func, aio, error, xid, res](PPUThread& CPU)
+		u32 fd;
 		{
-			func(CPU, aio, error, xid, res);
-		});
-	}
+			std::unique_lock<std::mutex> lock(g_FsAioMutex);
+
+			auto found = g_FsAioQueue.end();
+
+			while (true)
+			{
+				if (generation != g_FsAioGeneration || Emu.IsStopped())
+				{
+					return;
+				}
+
+				// first request for a file which isn't processed by another worker
+				found = std::find_if(g_FsAioQueue.begin(), g_FsAioQueue.end(), [](const FsAioRequest& req)
+				{
+					return !g_FsAioBusy.count(req.fd);
+				});
+
+				if (found != g_FsAioQueue.end())
+				{
+					break;
+				}
+
+				g_FsAioCond.wait_for(lock, std::chrono::milliseconds(10));
+			}
+
+			fd = found->fd;
+			g_FsAioBusy.insert(fd);
+
+			for (auto it = found; it != g_FsAioQueue.end() && batch.size() < g_FsAioMaxBatch;)
+			{
+				if (it->fd == fd)
+				{
+					batch.push_back(*it);
+					it = g_FsAioQueue.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+		}
+
+		fsAioProcess(batch);
+		batch.clear();
 
-	g_FsAioReadCur++;
+		{
+			std::lock_guard<std::mutex> lock(g_FsAioMutex);
+
+			if (generation == g_FsAioGeneration)
+			{
+				g_FsAioBusy.erase(fd);
+			}
+		}
+
+		// other requests for this fd may be waiting
+		g_FsAioCond.notify_all();
+	}
 }
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, vm::ptr<void(*)(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)> func)
+s32 fsAioSubmit(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func, bool write)
 {
-	sys_fs->Warning("cellFsAioRead(aio=0x%x, id=0x%x, func=0x%x)", aio, id, func);
-
 	if (!aio_init)
 	{
 		return CELL_ENXIO;
@@ -959,19 +1069,63 @@ s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, vm::ptr<void(*)(vm::p
 	}
 
 	//get a unique id for the callback (may be used by cellFsAioCancel)
-	const s32 xid = g_FsAioReadID++;
+	const s32 xid = g_FsAioID++;
 	*id = xid;
 
-	thread_t t("CellFsAio Reading Thread", std::bind(fsAioRead, fd, aio, xid, func));
+	{
+		std::lock_guard<std::mutex> lock(g_FsAioMutex);
+
+		FsAioRequest req;
+		req.fd = fd;
+		req.aio = aio;
+		req.xid = xid;
+		req.func = func;
+		req.write = write;
+		g_FsAioQueue.push_back(req);
+
+		// start the workers on first use
+		for (; g_FsAioWorkers < g_FsAioWorkerCount; g_FsAioWorkers++)
+		{
+			thread_t t(fmt::Format("CellFsAio Worker[%d]", g_FsAioWorkers), std::bind(fsAioWorker, g_FsAioGeneration));
+		}
+	}
+
+	g_FsAioCond.notify_one();
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, vm::ptr<void(*)(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)> func)
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	sys_fs->Todo("cellFsAioWrite(aio=0x%x, id=0x%x, func=0x%x)", aio, id, func);
+	sys_fs->Warning("cellFsAioRead(aio=0x%x, id=0x%x, func=0x%x)", aio, id, func);
 
-	// TODO:
+	return fsAioSubmit(aio, id, func, false);
+}
+
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	sys_fs->Warning("cellFsAioWrite(aio=0x%x, id=0x%x, func=0x%x)", aio, id, func);
+
+	return fsAioSubmit(aio, id, func, true);
+}
+
+s32 cellFsAioCancel(s32 id)
+{
+	sys_fs->Warning("cellFsAioCancel(id=0x%x)", id);
+
+	std::lock_guard<std::mutex> lock(g_FsAioMutex);
+
+	// only requests which haven't been taken by a worker can be cancelled, no callback is called for them
+	auto found = std::find_if(g_FsAioQueue.begin(), g_FsAioQueue.end(), [id](const FsAioRequest& req)
+	{
+		return req.xid == id;
+	});
 
+	if (found == g_FsAioQueue.end())
+	{
+		return CELL_EINVAL;
+	}
+
+	g_FsAioQueue.erase(found);
 	return CELL_OK;
 }
 
@@ -1038,6 +1192,7 @@ void sys_fs_init(Module *pxThis)
 	sys_fs->AddFunc(0x4cef342e, cellFsAioWrite);
 	sys_fs->AddFunc(0xdb869f20, cellFsAioInit);
 	sys_fs->AddFunc(0x9f951810, cellFsAioFinish);
+	sys_fs->AddFunc(0x7f13fc8c, cellFsAioCancel);
 	sys_fs->AddFunc(0x1a108ab7, cellFsGetBlockSize);
 	sys_fs->AddFunc(0xaa3b4bcd, cellFsGetFreeSize);
 	sys_fs->AddFunc(0x0d5b4a14, cellFsReadWithOffset);
@@ -1058,7 +1213,16 @@ void sys_fs_init(Module *pxThis)
 
 void sys_fs_load()
 {
-	g_FsAioReadID = 0;
-	g_FsAioReadCur = 0;
+	{
+		std::lock_guard<std::mutex> lock(g_FsAioMutex);
+
+		g_FsAioQueue.clear();
+		g_FsAioBusy.clear();
+		g_FsAioGeneration++;
+		g_FsAioWorkers = 0;
+	}
+
+	g_FsAioCond.notify_all();
+	g_FsAioID = 0;
 	aio_init = false;
 }
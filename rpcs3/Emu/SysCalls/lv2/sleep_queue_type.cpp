@@ -7,6 +7,8 @@
 
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/PPUThread.h"
+#include "Emu/TimerManager.h"
+#include "sys_time.h"
 #include "sleep_queue_type.h"
 
 sleep_queue_t::~sleep_queue_t()
@@ -29,6 +31,7 @@ void sleep_queue_t::push(u32 tid, u32 protocol)
 	{
 	case SYS_SYNC_FIFO:
 	case SYS_SYNC_PRIORITY:
+	case SYS_SYNC_RETRY: // never signaled, only tracked for notify_all()
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -53,10 +56,7 @@ void sleep_queue_t::push(u32 tid, u32 protocol)
 		}
 
 		m_waiting.push_back(tid);
-		return;
-	}
-	case SYS_SYNC_RETRY:
-	{
+		m_waiting_count = (u32)m_waiting.size();
 		return;
 	}
 	}
@@ -74,33 +74,42 @@ bool sleep_queue_t::pop(u32 tid, u32 protocol)
 	case SYS_SYNC_FIFO:
 	case SYS_SYNC_PRIORITY:
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		if (m_signaled.size() && m_signaled[0] == tid)
+		u32 next = 0;
 		{
-			m_signaled.erase(m_signaled.begin());
-			return true;
-		}
+			std::lock_guard<std::mutex> lock(m_mutex);
 
-		for (auto& v : m_signaled)
-		{
-			if (v == tid)
+			if (m_signaled.size() && m_signaled[0] == tid)
 			{
-				return false;
+				m_signaled.erase(m_signaled.begin());
+				next = m_signaled.size() ? m_signaled[0] : 0;
 			}
-		}
-
-		for (auto& v : m_waiting)
-		{
-			if (v == tid)
+			else
 			{
-				return false;
+				for (auto& v : m_signaled)
+				{
+					if (v == tid)
+					{
+						return false;
+					}
+				}
+
+				for (auto& v : m_waiting)
+				{
+					if (v == tid)
+					{
+						return false;
+					}
+				}
+
+				LOG_ERROR(HLE, "sleep_queue_t['%s']::pop() failed: thread not found (%d)", m_name.c_str(), tid);
+				Emu.Pause();
+				return true; // ???
 			}
 		}
 
-		LOG_ERROR(HLE, "sleep_queue_t['%s']::pop() failed: thread not found (%d)", m_name.c_str(), tid);
-		Emu.Pause();
-		return true; // ???
+		// the next signaled thread may have been woken up before it became the head, so it could be sleeping again
+		notify(next);
+		return true;
 	}
 	//case SYS_SYNC_RETRY: // ???
 	//{
@@ -133,6 +142,7 @@ u32 sleep_queue_t::signal(u32 protocol)
 			}
 
 			m_waiting.erase(m_waiting.begin());
+			m_waiting_count = (u32)m_waiting.size();
 			m_signaled.push_back(res);
 		}
 		else
@@ -170,6 +180,7 @@ u32 sleep_queue_t::signal(u32 protocol)
 		{
 			res = m_waiting[sel];
 			m_waiting.erase(m_waiting.begin() + sel);
+			m_waiting_count = (u32)m_waiting.size();
 			m_signaled.push_back(res);
 			return res;
 		}
@@ -202,6 +213,7 @@ bool sleep_queue_t::invalidate(u32 tid, u32 protocol)
 			if (v == tid)
 			{
 				m_waiting.erase(m_waiting.begin() + (&v - m_waiting.data()));
+				m_waiting_count = (u32)m_waiting.size();
 				return true;
 			}
 		}
@@ -223,6 +235,18 @@ bool sleep_queue_t::invalidate(u32 tid, u32 protocol)
 	}
 	case SYS_SYNC_RETRY:
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (auto& v : m_waiting)
+		{
+			if (v == tid)
+			{
+				m_waiting.erase(m_waiting.begin() + (&v - m_waiting.data()));
+				m_waiting_count = (u32)m_waiting.size();
+				break;
+			}
+		}
+
 		return true;
 	}
 	}
@@ -243,6 +267,7 @@ bool sleep_queue_t::signal_selected(u32 tid)
 		if (v == tid)
 		{
 			m_waiting.erase(m_waiting.begin() + (&v - m_waiting.data()));
+			m_waiting_count = (u32)m_waiting.size();
 			m_signaled.push_back(tid);
 			return true;
 		}
@@ -257,3 +282,95 @@ u32 sleep_queue_t::count()
 
 	return (u32)m_waiting.size() + (u32)m_signaled.size();
 }
+
+
+void sleep_queue_t::wait(u64 start_time, u64 timeout)
+{
+	u64 wait_time = SLEEP_QUEUE_MAX_WAIT;
+
+	if (timeout)
+	{
+		const u64 passed = get_system_time() - start_time;
+		if (passed >= timeout)
+		{
+			return;
+		}
+
+		wait_time = std::min<u64>((timeout - passed + 999) / 1000, wait_time);
+	}
+
+	if (NamedThreadBase* thread = GetCurrentNamedThread())
+	{
+		PPUSchedulerBlock block;
+
+		if (timeout)
+		{
+			// wake up precisely at the timeout
+			const u32 id = Emu.GetTimerManager().Add(start_time + timeout, 0, [thread](u64)
+			{
+				thread->Notify();
+			});
+
+			thread->WaitForAnySignal(wait_time);
+
+			Emu.GetTimerManager().Remove(id);
+		}
+		else
+		{
+			thread->WaitForAnySignal(wait_time);
+		}
+	}
+	else
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+	}
+}
+
+void sleep_queue_t::notify(u32 tid)
+{
+	if (!tid)
+	{
+		return;
+	}
+
+	if (!Emu.GetCPU().NotifyThread(tid))
+	{
+		LOG_ERROR(HLE, "sleep_queue_t['%s']::notify() failed: invalid thread (%d)", m_name.c_str(), tid);
+		Emu.Pause();
+	}
+}
+
+void sleep_queue_t::notify_waiting()
+{
+	if (!m_waiting_count.load())
+	{
+		return; // nobody to wake up, don't touch the mutex
+	}
+
+	u32 tid = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_waiting.size())
+		{
+			tid = m_waiting[0];
+		}
+	}
+
+	notify(tid);
+}
+
+void sleep_queue_t::notify_all()
+{
+	std::vector<u32> waiting;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		waiting = m_waiting;
+	}
+
+	for (auto& tid : waiting)
+	{
+		notify(tid);
+	}
+}
\ No newline at end of file
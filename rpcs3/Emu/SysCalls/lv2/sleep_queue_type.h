@@ -26,18 +26,23 @@ enum
 	SYS_SYNC_ATTR_RECURSIVE_MASK = 0xF0, //???
 };
 
+// max time (in milliseconds) a thread stays blocked in sleep_queue_t::wait() without being notified
+const u64 SLEEP_QUEUE_MAX_WAIT = 100;
+
 class sleep_queue_t
 {
 	std::vector<u32> m_waiting;
 	std::vector<u32> m_signaled;
 	std::mutex m_mutex;
 	std::string m_name;
+	std::atomic<u32> m_waiting_count; // m_waiting.size(), readable without the mutex
 
 public:
 	const u64 name;
 
 	sleep_queue_t(u64 name = 0)
-		: name(name)
+		: m_waiting_count(0)
+		, name(name)
 	{
 	}
 
@@ -52,4 +57,14 @@ public:
 	bool signal_selected(u32 tid);
 	bool invalidate(u32 tid, u32 protocol);
 	u32 count();
+
+	// block the current thread until notified (start_time and timeout in microseconds, timeout = 0 means infinite)
+	static void wait(u64 start_time, u64 timeout);
+	// wake up the thread selected by signal() or signal_selected() (after the protected state was updated)
+	void notify(u32 tid);
+	// wake up the first waiting thread (it should re-check the condition and select the next thread itself),
+	// doesn't lock anything if no thread is waiting
+	void notify_waiting();
+	// wake up all waiting threads (they should re-check the condition)
+	void notify_all();
 };
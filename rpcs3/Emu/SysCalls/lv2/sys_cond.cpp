@@ -71,6 +71,7 @@ s32 sys_cond_signal(u32 cond_id)
 	}
 
 	u32 target = cond->queue.signal(cond->mutex->protocol);
+	cond->queue.notify(target);
 	return CELL_OK;
 }
 
@@ -88,6 +89,8 @@ s32 sys_cond_signal_all(u32 cond_id)
 
 	while (u32 target = cond->queue.signal(mutex->protocol))
 	{
+		cond->queue.notify(target);
+
 		if (Emu.IsStopped())
 		{
 			sys_cond.Warning("sys_cond_signal_all(id=%d) aborted", cond_id);
@@ -117,6 +120,7 @@ s32 sys_cond_signal_to(u32 cond_id, u32 thread_id)
 	{
 		return CELL_EPERM;
 	}
+	cond->queue.notify(thread_id);
 	return CELL_OK;
 }
 
@@ -144,10 +148,12 @@ s32 sys_cond_wait(PPUThread& CPU, u32 cond_id, u64 timeout)
 
 	auto old_recursive = mutex->recursive_count.load();
 	mutex->recursive_count = 0;
-	if (!mutex->owner.compare_and_swap_test(tid, mutex->queue.signal(mutex->protocol)))
+	const u32 target = mutex->queue.signal(mutex->protocol);
+	if (!mutex->owner.compare_and_swap_test(tid, target))
 	{
 		assert(!"sys_cond_wait() failed");
 	}
+	mutex->queue.notify(target);
 
 	bool pushed_in_sleep_queue = false, signaled = false;
 	while (true)
@@ -172,7 +178,7 @@ s32 sys_cond_wait(PPUThread& CPU, u32 cond_id, u64 timeout)
 			}
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		cond->queue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -13,6 +13,18 @@
 
 SysCallBase sys_event("sys_event");
 
+bool EventQueue::push(u64 source, u64 d1, u64 d2, u64 d3)
+{
+	if (!events.push(source, d1, d2, d3))
+	{
+		return false;
+	}
+
+	// the receiver woken up will pass the event to the thread selected by protocol
+	sq.notify_waiting();
+	return true;
+}
+
 u32 event_queue_create(u32 protocol, s32 type, u64 name_u64, u64 event_queue_key, s32 size)
 {
 	std::shared_ptr<EventQueue> eq(new EventQueue(protocol, type, name_u64, event_queue_key, size));
@@ -190,6 +202,15 @@ s32 sys_event_queue_receive(u32 equeue_id, vm::ptr<sys_event_data> dummy_event,
 				{
 					assert(!"sys_event_queue_receive() failed (I)");
 				}
+
+				if (next)
+				{
+					eq->sq.notify(next);
+				}
+				else if (eq->events.count())
+				{
+					continue; // the event was pushed while the queue was owned
+				}
 				break;
 			}
 			// fallthrough
@@ -214,6 +235,10 @@ s32 sys_event_queue_receive(u32 equeue_id, vm::ptr<sys_event_data> dummy_event,
 			{
 				assert(!"sys_event_queue_receive() failed (receiving)");
 			}
+			if (eq->events.count())
+			{
+				eq->sq.notify_waiting();
+			}
 			return CELL_OK;
 		}
 		}
@@ -227,7 +252,7 @@ s32 sys_event_queue_receive(u32 equeue_id, vm::ptr<sys_event_data> dummy_event,
 			return CELL_ECANCELED;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		eq->sq.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -394,7 +419,7 @@ s32 sys_event_port_send(u32 eport_id, u64 data1, u64 data2, u64 data3)
 		return CELL_ENOTCONN;
 	}
 
-	if (!eq->events.push(eport->name, data1, data2, data3))
+	if (!eq->push(eport->name, data1, data2, data3))
 	{
 		return CELL_EBUSY;
 	}
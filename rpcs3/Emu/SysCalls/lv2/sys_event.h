@@ -66,85 +66,159 @@ struct EventPort
 	}
 };
 
+// bounded lock-free queue (any number of senders and receivers):
+// every cell has a sequence number which tells whether it's ready to be written (pos) or read (pos + 1)
 class EventRingBuffer
 {
-	std::vector<sys_event_data> data;
-	std::mutex m_mutex;
-	u32 buf_pos;
-	u32 buf_count;
+	struct cell_t
+	{
+		std::atomic<u32> seq;
+		sys_event_data data;
+	};
+
+	std::unique_ptr<cell_t[]> m_cells;
+	const u32 m_mask;
+	std::atomic<u32> m_push_pos;
+	std::atomic<u32> m_pop_pos;
+
+	static u32 get_capacity(u32 size)
+	{
+		// at least twice the queue size, so a sender almost never reaches a cell which is still being read
+		u32 res = 1;
+		while (res < size * 2) res <<= 1;
+		return res;
+	}
 
 public:
 	const u32 size;
 
 	EventRingBuffer(u32 size)
-		: size(size)
-		, buf_pos(0)
-		, buf_count(0)
+		: m_mask(get_capacity(size) - 1)
+		, m_push_pos(0)
+		, m_pop_pos(0)
+		, size(size)
 	{
-		data.resize(size);
+		m_cells.reset(new cell_t[m_mask + 1]);
+
+		for (u32 i = 0; i <= m_mask; i++)
+		{
+			m_cells[i].seq.store(i, std::memory_order_relaxed);
+		}
 	}
 
 	void clear()
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		buf_count = 0;
-		buf_pos = 0;
+		sys_event_data dummy;
+		while (pop_all(&dummy, 1));
 	}
 
 	bool push(u64 name, u64 d1, u64 d2, u64 d3)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		if (buf_count >= size) return false;
+		u32 pos = m_push_pos.load();
+
+		while (true)
+		{
+			if ((s32)(pos - m_pop_pos.load()) >= (s32)size)
+			{
+				return false; // full
+			}
 
-		sys_event_data& ref = data[(buf_pos + buf_count++) % size];
-		ref.source = name;
-		ref.data1 = d1;
-		ref.data2 = d2;
-		ref.data3 = d3;
+			cell_t& cell = m_cells[pos & m_mask];
+			const s32 diff = (s32)(cell.seq.load(std::memory_order_acquire) - pos);
 
-		return true;
+			if (diff == 0)
+			{
+				if (m_push_pos.compare_exchange_weak(pos, pos + 1))
+				{
+					cell.data.source = name;
+					cell.data.data1 = d1;
+					cell.data.data2 = d2;
+					cell.data.data3 = d3;
+					cell.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else
+			{
+				if (diff < 0)
+				{
+					std::this_thread::yield(); // the previous event in this cell is still being read
+				}
+
+				pos = m_push_pos.load();
+			}
+		}
 	}
 
 	bool pop(sys_event_data& ref)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		if (!buf_count) return false;
+		while (!pop_all(&ref, 1))
+		{
+			if (!count())
+			{
+				return false;
+			}
 
-		sys_event_data& from = data[buf_pos];
-		buf_pos = (buf_pos + 1) % size;
-		buf_count--;
-		ref.source = from.source;
-		ref.data1 = from.data1;
-		ref.data2 = from.data2;
-		ref.data3 = from.data3;
+			std::this_thread::yield(); // the event is still being written
+		}
 
 		return true;
 	}
 
+	// receive up to max events which are ready (claimed with a single CAS)
 	u32 pop_all(sys_event_data* ptr, u32 max)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
+		u32 pos = m_pop_pos.load();
 
-		u32 res = 0;
-		while (buf_count && max)
+		while (max)
 		{
-			sys_event_data& from = data[buf_pos];
-			ptr->source = from.source;
-			ptr->data1 = from.data1;
-			ptr->data2 = from.data2;
-			ptr->data3 = from.data3;
-			buf_pos = (buf_pos + 1) % size;
-			buf_count--;
-			max--;
-			ptr++;
-			res++;
+			u32 res = 0;
+			bool stale = false;
+
+			for (; res < max; res++)
+			{
+				const s32 diff = (s32)(m_cells[(pos + res) & m_mask].seq.load(std::memory_order_acquire) - (pos + res + 1));
+
+				if (diff)
+				{
+					stale = diff > 0 && !res; // pos has been claimed by another receiver
+					break;
+				}
+			}
+
+			if (stale)
+			{
+				pos = m_pop_pos.load();
+				continue;
+			}
+
+			if (!res)
+			{
+				return 0;
+			}
+
+			if (m_pop_pos.compare_exchange_weak(pos, pos + res))
+			{
+				for (u32 i = 0; i < res; i++)
+				{
+					cell_t& cell = m_cells[(pos + i) & m_mask];
+					ptr[i] = cell.data;
+					cell.seq.store(pos + i + m_mask + 1, std::memory_order_release);
+				}
+
+				return res;
+			}
 		}
-		return res;
+
+		return 0;
 	}
 
+	// includes events which are still being written
 	u32 count() const
 	{
-		return buf_count;
+		const u32 pop_pos = m_pop_pos.load();
+		const s32 res = (s32)(m_push_pos.load() - pop_pos);
+		return res > 0 ? res : 0;
 	}
 };
 
@@ -212,6 +286,8 @@ struct EventQueue
 	{
 		owner.write_relaxed(0);
 	}
+
+	bool push(u64 source, u64 d1, u64 d2, u64 d3);
 };
 
 // Aux
@@ -7,6 +7,7 @@
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/PPUThread.h"
 #include "sleep_queue_type.h"
+#include "sys_time.h"
 #include "sys_event_flag.h"
 
 SysCallBase sys_event_flag("sys_event_flag");
@@ -121,6 +122,8 @@ s32 sys_event_flag_wait(u32 eflag_id, u64 bitptn, u32 mode, vm::ptr<u64> result,
 	sys_event_flag.Log("sys_event_flag_wait(eflag_id=%d, bitptn=0x%llx, mode=0x%x, result_addr=0x%x, timeout=%lld)",
 		eflag_id, bitptn, mode, result.addr(), timeout);
 
+	const u64 start_time = get_system_time();
+
 	if (result) *result = 0;
 
 	switch (mode & 0xf)
@@ -180,9 +183,6 @@ s32 sys_event_flag_wait(u32 eflag_id, u64 bitptn, u32 mode, vm::ptr<u64> result,
 		}
 	}
 
-	u64 counter = 0;
-	const u64 max_counter = timeout ? (timeout / 1000) : ~0;
-
 	while (true)
 	{
 		u32 signaled;
@@ -194,6 +194,12 @@ s32 sys_event_flag_wait(u32 eflag_id, u64 bitptn, u32 mode, vm::ptr<u64> result,
 
 			ef->signal.pop(signaled);
 
+			// the next signaled thread may be waiting for its turn
+			if (ef->signal.try_peek(signaled))
+			{
+				Emu.GetCPU().NotifyThread(signaled);
+			}
+
 			for (u32 i = 0; i < ef->waiters.size(); i++)
 			{
 				if (ef->waiters[i].tid == tid)
@@ -212,6 +218,7 @@ s32 sys_event_flag_wait(u32 eflag_id, u64 bitptn, u32 mode, vm::ptr<u64> result,
 					if (u32 target = ef->check())
 					{
 						ef->signal.push(target);
+						Emu.GetCPU().NotifyThread(target);
 					}
 
 					if (result)
@@ -225,9 +232,9 @@ s32 sys_event_flag_wait(u32 eflag_id, u64 bitptn, u32 mode, vm::ptr<u64> result,
 			return CELL_ECANCELED;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		sleep_queue_t::wait(start_time, timeout);
 
-		if (counter++ > max_counter)
+		if (timeout && get_system_time() - start_time > timeout)
 		{
 			std::lock_guard<std::mutex> lock(ef->mutex);
 
@@ -315,6 +322,7 @@ s32 sys_event_flag_set(u32 eflag_id, u64 bitptn)
 	if (u32 target = ef->check())
 	{
 		ef->signal.push(target);
+		Emu.GetCPU().NotifyThread(target);
 	}
 	return CELL_OK;
 }
@@ -353,6 +361,7 @@ s32 sys_event_flag_cancel(u32 eflag_id, vm::ptr<u32> num)
 	for (auto& v : tids)
 	{
 		ef->signal.push(v);
+		Emu.GetCPU().NotifyThread(v);
 	}
 
 	if (Emu.IsStopped())
@@ -71,6 +71,8 @@ s32 sys_lwcond_signal(vm::ptr<sys_lwcond_t> lwcond)
 
 	if (u32 target = lw->queue.signal(mutex->attribute))
 	{
+		lw->queue.notify(target);
+
 		if (Emu.IsStopped())
 		{
 			sys_lwcond.Warning("sys_lwcond_signal(id=%d) aborted", (u32)lwcond->lwcond_queue);
@@ -95,6 +97,8 @@ s32 sys_lwcond_signal_all(vm::ptr<sys_lwcond_t> lwcond)
 
 	while (u32 target = lw->queue.signal(mutex->attribute))
 	{
+		lw->queue.notify(target);
+
 		if (Emu.IsStopped())
 		{
 			sys_lwcond.Warning("sys_lwcond_signal_all(id=%d) aborted", (u32)lwcond->lwcond_queue);
@@ -125,6 +129,8 @@ s32 sys_lwcond_signal_to(vm::ptr<sys_lwcond_t> lwcond, u32 ppu_thread_id)
 		return CELL_EPERM;
 	}
 
+	lw->queue.notify(ppu_thread_id);
+
 	return CELL_OK;
 }
 
@@ -167,6 +173,7 @@ s32 sys_lwcond_wait(PPUThread& CPU, vm::ptr<sys_lwcond_t> lwcond, u64 timeout)
 	{
 		assert(!"sys_lwcond_wait(): mutex unlocking failed");
 	}
+	sq->notify(target);
 
 	bool signaled = false;
 	while (true)
@@ -208,7 +215,7 @@ s32 sys_lwcond_wait(PPUThread& CPU, vm::ptr<sys_lwcond_t> lwcond, u64 timeout)
 			}
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		lw->queue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -161,10 +161,20 @@ s32 sys_lwmutex_t::unlock(be_t<u32> tid)
 			return CELL_ESRCH;
 		}
 
-		if (!owner.compare_and_swap_test(tid, be_t<u32>::make(sq->signal(attribute))))
+		const u32 target = sq->signal(attribute);
+		if (!owner.compare_and_swap_test(tid, be_t<u32>::make(target)))
 		{
 			assert(!"sys_lwmutex_t::unlock() failed");
 		}
+
+		if (target)
+		{
+			sq->notify(target);
+		}
+		else if ((attribute.data() & se32(SYS_SYNC_ATTR_PROTOCOL_MASK)) == se32(SYS_SYNC_RETRY))
+		{
+			sq->notify_all(); // all waiting threads retry
+		}
 	}
 
 	return CELL_OK;
@@ -196,7 +206,7 @@ s32 sys_lwmutex_t::lock(be_t<u32> tid, u64 timeout)
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		sq->wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -141,7 +141,7 @@ s32 sys_mutex_lock(PPUThread& CPU, u32 mutex_id, u64 timeout)
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		mutex->queue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -241,10 +241,12 @@ s32 sys_mutex_unlock(PPUThread& CPU, u32 mutex_id)
 
 	if (!--mutex->recursive_count)
 	{
-		if (!mutex->owner.compare_and_swap_test(tid, mutex->queue.signal(mutex->protocol)))
+		const u32 target = mutex->queue.signal(mutex->protocol);
+		if (!mutex->owner.compare_and_swap_test(tid, target))
 		{
 			assert(!"sys_mutex_unlock() failed");
 		}
+		mutex->queue.notify(target);
 		CPU.owned_mutexes--;
 	}
 	return CELL_OK;
@@ -7,6 +7,7 @@
 
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/PPUThread.h"
+#include "sleep_queue_type.h"
 #include "sys_ppu_thread.h"
 
 static SysCallBase sys_ppu_thread("sys_ppu_thread");
@@ -39,29 +40,39 @@ void sys_internal_ppu_thread_exit(PPUThread& CPU, u64 errorcode)
 	ppu_thread_exit(CPU, errorcode);
 }
 
-s32 sys_ppu_thread_yield()
+s32 sys_ppu_thread_yield(PPUThread& CPU)
 {
 	sys_ppu_thread.Log("sys_ppu_thread_yield()");
-	// Note: Or do we actually want to yield?
-	std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+
+	Emu.GetCPU().PPUYield(CPU);
 	return CELL_OK;
 }
 
-s32 sys_ppu_thread_join(u64 thread_id, vm::ptr<u64> vptr)
+s32 sys_ppu_thread_join(PPUThread& CPU, u64 thread_id, vm::ptr<u64> vptr)
 {
 	sys_ppu_thread.Warning("sys_ppu_thread_join(thread_id=%lld, vptr_addr=0x%x)", thread_id, vptr.addr());
 
 	std::shared_ptr<CPUThread> thr = Emu.GetCPU().GetThread(thread_id);
 	if(!thr) return CELL_ESRCH;
 
-	while (thr->IsAlive())
+	if (thr->GetType() == CPU_THREAD_PPU)
+	{
+		// woken up by the thread when it finishes
+		std::static_pointer_cast<PPUThread>(thr)->joiner = CPU.GetId();
+	}
+
+	PPUSchedulerBlock block;
+
+	// the thread is stopped before it exits, the exit status is already set at this point
+	while (thr->IsAlive() && !thr->IsStopped())
 	{
 		if (Emu.IsStopped())
 		{
 			sys_ppu_thread.Warning("sys_ppu_thread_join(%d) aborted", thread_id);
 			return CELL_OK;
 		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+
+		CPU.WaitForAnySignal(SLEEP_QUEUE_MAX_WAIT);
 	}
 
 	*vptr = thr->GetExitStatus();
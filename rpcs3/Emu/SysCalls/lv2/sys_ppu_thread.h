@@ -20,8 +20,8 @@ PPUThread* ppu_thread_create(u32 entry, u64 arg, s32 prio, u32 stacksize, bool i
 // SysCalls
 void sys_ppu_thread_exit(PPUThread& CPU, u64 errorcode);
 void sys_internal_ppu_thread_exit(PPUThread& CPU, u64 errorcode);
-s32 sys_ppu_thread_yield();
-s32 sys_ppu_thread_join(u64 thread_id, vm::ptr<u64> vptr);
+s32 sys_ppu_thread_yield(PPUThread& CPU);
+s32 sys_ppu_thread_join(PPUThread& CPU, u64 thread_id, vm::ptr<u64> vptr);
 s32 sys_ppu_thread_detach(u64 thread_id);
 void sys_ppu_thread_get_join_state(PPUThread& CPU, vm::ptr<s32> isjoinable);
 s32 sys_ppu_thread_set_priority(u64 thread_id, s32 prio);
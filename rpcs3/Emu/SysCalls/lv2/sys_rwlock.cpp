@@ -40,6 +40,7 @@ s32 sys_rwlock_create(vm::ptr<u32> rw_lock_id, vm::ptr<sys_rwlock_attribute_t> a
 	const u32 id = sys_rwlock.GetNewId(rw, TYPE_RWLOCK);
 	*rw_lock_id = id;
 	rw->wqueue.set_full_name(fmt::Format("Rwlock(%d)", id));
+	rw->rqueue.set_full_name(fmt::Format("Rwlock(%d, readers)", id));
 
 	sys_rwlock.Warning("*** rwlock created [%s] (protocol=0x%x): id = %d", std::string(attr->name, 8).c_str(), rw->protocol, id);
 	return CELL_OK;
@@ -76,7 +77,7 @@ s32 sys_rwlock_rlock(u32 rw_lock_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
-	while (true)
+	auto try_rlock = [&rw]() -> bool
 	{
 		bool succeeded;
 		rw->sync.atomic_op_sync([&succeeded](RWLock::sync_var_t& sync)
@@ -88,15 +89,33 @@ s32 sys_rwlock_rlock(u32 rw_lock_id, u64 timeout)
 			}
 		});
 
-		if (succeeded)
+		return succeeded;
+	};
+
+	if (try_rlock())
+	{
+		return CELL_OK;
+	}
+
+	const u32 tid = GetCurrentPPUThread().GetId();
+
+	rw->rqueue.push(tid, rw->protocol);
+
+	while (true)
+	{
+		if (try_rlock())
 		{
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		rw->rqueue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
+			if (!rw->rqueue.invalidate(tid, rw->protocol))
+			{
+				assert(!"sys_rwlock_rlock() failed (timeout)");
+			}
 			return CELL_ETIMEDOUT;
 		}
 
@@ -107,6 +126,10 @@ s32 sys_rwlock_rlock(u32 rw_lock_id, u64 timeout)
 		}
 	}
 
+	if (!rw->rqueue.invalidate(tid, rw->protocol))
+	{
+		assert(!"sys_rwlock_rlock() failed (locking)");
+	}
 	return CELL_OK;
 }
 
@@ -148,18 +171,23 @@ s32 sys_rwlock_runlock(u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
-	bool succeeded;
-	rw->sync.atomic_op_sync([&succeeded](RWLock::sync_var_t& sync)
+	bool succeeded, released;
+	rw->sync.atomic_op_sync([&succeeded, &released](RWLock::sync_var_t& sync)
 	{
 		if ((succeeded = sync.readers != 0))
 		{
 			assert(!sync.writer);
-			sync.readers--;
+			released = !--sync.readers;
 		}
 	});
 
 	if (succeeded)
 	{
+		if (released)
+		{
+			// the first waiting writer will try to lock it
+			rw->wqueue.notify_waiting();
+		}
 		return CELL_OK;
 	}
 
@@ -200,7 +228,7 @@ s32 sys_rwlock_wlock(PPUThread& CPU, u32 rw_lock_id, u64 timeout)
 			break;
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		rw->wqueue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -265,9 +293,13 @@ s32 sys_rwlock_wunlock(PPUThread& CPU, u32 rw_lock_id)
 
 	if (rw->sync.compare_and_swap_test({ 0, tid }, { 0, target }))
 	{
-		if (!target)
+		if (target)
+		{
+			rw->wqueue.notify(target);
+		}
+		else
 		{
-			// TODO: signal readers
+			rw->rqueue.notify_all();
 		}
 		return CELL_OK;
 	}
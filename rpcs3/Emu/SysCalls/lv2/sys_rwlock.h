@@ -23,6 +23,7 @@ struct RWLock
 	};
 
 	sleep_queue_t wqueue;
+	sleep_queue_t rqueue; // readers waiting for the writer
 	atomic_le_t<sync_var_t> sync;
 
 	const u32 protocol;
@@ -30,6 +31,7 @@ struct RWLock
 	RWLock(u32 protocol, u64 name)
 		: protocol(protocol)
 		, wqueue(name)
+		, rqueue(name)
 	{
 		sync.write_relaxed({ 0, 0 });
 	}
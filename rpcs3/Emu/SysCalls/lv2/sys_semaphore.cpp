@@ -126,7 +126,7 @@ s32 sys_semaphore_wait(u32 sem_id, u64 timeout)
 		}
 
 		assert(!sem->value.read_sync());
-		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+		sem->queue.wait(start_time, timeout);
 
 		if (timeout && get_system_time() - start_time > timeout)
 		{
@@ -212,6 +212,7 @@ s32 sys_semaphore_post(u32 sem_id, s32 count)
 
 		if (u32 target = sem->queue.signal(sem->protocol))
 		{
+			sem->queue.notify(target);
 			count--;
 		}
 		else
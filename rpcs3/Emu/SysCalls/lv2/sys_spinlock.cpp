@@ -4,6 +4,8 @@
 #include "Emu/SysCalls/SysCalls.h"
 #include "Emu/Memory/atomic_type.h"
 
+#include "Emu/CPU/CPUThreadManager.h"
+
 #include "sys_spinlock.h"
 
 SysCallBase sys_spinlock("sys_spinlock");
@@ -23,6 +25,8 @@ void sys_spinlock_lock(vm::ptr<atomic_t<u32>> lock)
 	// prx: exchange with 0xabadcafe, repeat until exchanged with 0
 	while (lock->exchange(be_t<u32>::make(0xabadcafe)).data())
 	{
+		PPUSchedulerBlock block;
+
 		while (lock->read_relaxed().data())
 		{
 			std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
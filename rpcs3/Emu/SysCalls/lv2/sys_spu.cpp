@@ -485,6 +485,8 @@ s32 sys_spu_thread_group_join(u32 id, vm::ptr<u32> cause, vm::ptr<u32> status)
 		return CELL_EBUSY;
 	}
 
+	PPUSchedulerBlock block;
+
 	bool all_threads_exit = true;
 	for (u32 i = 0; i < group_info->list.size(); i++)
 	{
@@ -4,7 +4,13 @@
 #include "Emu/SysCalls/SysCalls.h"
 #include "Emu/Memory/atomic_type.h"
 
+#include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Event.h"
+#include "Emu/TimerManager.h"
+#include "sleep_queue_type.h"
+#include "sys_event.h"
+#include "sys_process.h"
+#include "sys_time.h"
 #include "sys_timer.h"
 
 SysCallBase sys_timer("sys_timer");
@@ -20,9 +26,14 @@ s32 sys_timer_create(vm::ptr<u32> timer_id)
 
 s32 sys_timer_destroy(u32 timer_id)
 {
-	sys_timer.Todo("sys_timer_destroy(timer_id=%d)", timer_id);
+	sys_timer.Warning("sys_timer_destroy(timer_id=%d)", timer_id);
 
-	if(!sys_timer.CheckId(timer_id)) return CELL_ESRCH;
+	std::shared_ptr<timer> timer_data = nullptr;
+	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
+
+	if (timer_data->port.lock()) return CELL_EISCONN;
+
+	timer_stop(*timer_data);
 
 	Emu.GetIdManager().RemoveID(timer_id);
 	return CELL_OK;
@@ -35,42 +46,91 @@ s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> inf
 	std::shared_ptr<timer> timer_data = nullptr;
 	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
 
+	std::lock_guard<std::mutex> lock(timer_data->mutex);
+
 	*info = timer_data->timer_information_t;
 	return CELL_OK;
 }
 
+void timer_stop(timer& timer_data)
+{
+	// wait for the callback if it's being executed, it doesn't run anymore after this
+	if (const u32 id = timer_data.service_id.exchange(0))
+	{
+		Emu.GetTimerManager().Remove(id);
+	}
+
+	std::lock_guard<std::mutex> lock(timer_data.mutex);
+
+	timer_data.timer_information_t.timer_state = SYS_TIMER_STATE_STOP;
+}
+
 s32 sys_timer_start(u32 timer_id, s64 base_time, u64 period)
 {
 	sys_timer.Warning("sys_timer_start_periodic_absolute(timer_id=%d, basetime=%lld, period=%lld)", timer_id, base_time, period);
 
+	const u64 start_time = get_system_time();
+
 	std::shared_ptr<timer> timer_data = nullptr;
 	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
 
+	std::lock_guard<std::mutex> lock(timer_data->mutex);
+
 	if(timer_data->timer_information_t.timer_state != SYS_TIMER_STATE_STOP) return CELL_EBUSY;
-	if(period < 100) return CELL_EINVAL;
-	//TODO: if (timer is not connected to an event queue) return CELL_ENOTCONN;
-	
-	timer_data->timer_information_t.next_expiration_time = base_time;
+
+	if (!period)
+	{
+		// oneshot timer
+		if (start_time >= (u64)base_time) return CELL_ETIMEDOUT;
+	}
+	else
+	{
+		// periodic timer
+		if (period < 100) return CELL_EINVAL;
+	}
+
+	if (!timer_data->port.lock()) return CELL_ENOTCONN;
+
+	timer_data->timer_information_t.next_expiration_time = base_time ? base_time : start_time + period;
 	timer_data->timer_information_t.period = period;
 	timer_data->timer_information_t.timer_state = SYS_TIMER_STATE_RUN;
-	//TODO: ?
-	std::function<s32()> task(std::bind(sys_timer_stop, timer_id));
-	std::thread([period, task]() {
-		std::this_thread::sleep_for(std::chrono::milliseconds(period));
-		task();
-	}).detach();
+
+	const std::shared_ptr<timer> t = timer_data;
+
+	timer_data->service_id = Emu.GetTimerManager().Add(timer_data->timer_information_t.next_expiration_time, period, [t](u64 next_deadline)
+	{
+		std::lock_guard<std::mutex> lock(t->mutex);
+
+		sys_timer_information_t& info = t->timer_information_t;
+		const u64 expiration_time = info.next_expiration_time;
+
+		if (info.period)
+		{
+			// TimerManager skips the periods which were missed completely
+			info.next_expiration_time = next_deadline;
+		}
+		else
+		{
+			info.timer_state = SYS_TIMER_STATE_STOP;
+		}
+
+		if (std::shared_ptr<EventQueue> queue = t->port.lock())
+		{
+			queue->push(t->source, t->data1, t->data2, expiration_time);
+		}
+	});
 
 	return CELL_OK;
 }
 
 s32 sys_timer_stop(u32 timer_id)
 {
-	sys_timer.Todo("sys_timer_stop()");
+	sys_timer.Warning("sys_timer_stop(timer_id=%d)", timer_id);
 
 	std::shared_ptr<timer> timer_data = nullptr;
 	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
 
-	timer_data->timer_information_t.timer_state = SYS_TIMER_STATE_STOP;
+	timer_stop(*timer_data);
 	return CELL_OK;
 }
 
@@ -84,35 +144,46 @@ s32 sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u64 data
 	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
 	if(!sys_timer.CheckId(queue_id, equeue)) return CELL_ESRCH;
 
-	//TODO: ?
+	std::lock_guard<std::mutex> lock(timer_data->mutex);
+
+	if (timer_data->port.lock()) return CELL_EISCONN;
+
+	timer_data->port = equeue;
+	timer_data->source = name ? name : ((u64)process_getpid() << 32) | timer_id;
+	timer_data->data1 = data1;
+	timer_data->data2 = data2;
 
 	return CELL_OK;
 }
 
 s32 sys_timer_disconnect_event_queue(u32 timer_id)
 {
-	sys_timer.Todo("sys_timer_disconnect_event_queue(timer_id=%d)", timer_id);
+	sys_timer.Warning("sys_timer_disconnect_event_queue(timer_id=%d)", timer_id);
 
 	std::shared_ptr<timer> timer_data = nullptr;
 	if(!sys_timer.CheckId(timer_id, timer_data)) return CELL_ESRCH;
 
-	//TODO: ?
+	if (!timer_data->port.lock()) return CELL_ENOTCONN;
 
+	timer_stop(*timer_data);
+
+	std::lock_guard<std::mutex> lock(timer_data->mutex);
+
+	timer_data->port.reset();
 	return CELL_OK;
 }
 
 s32 sys_timer_sleep(u32 sleep_time)
 {
 	sys_timer.Log("sys_timer_sleep(sleep_time=%d)", sleep_time);
-	for (u32 i = 0; i < sleep_time; i++)
+
+	PPUSchedulerBlock block;
+
+	if (!Emu.GetTimerManager().SleepUntil(get_system_time() + (u64)sleep_time * 1000000))
 	{
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-		if (Emu.IsStopped())
-		{
-			sys_timer.Warning("sys_timer_sleep(sleep_time=%d) aborted", sleep_time);
-			return CELL_OK;
-		}
+		sys_timer.Warning("sys_timer_sleep(sleep_time=%d) aborted", sleep_time);
 	}
+
 	return CELL_OK;
 }
 
@@ -120,15 +191,13 @@ s32 sys_timer_usleep(u64 sleep_time)
 {
 	sys_timer.Log("sys_timer_usleep(sleep_time=%lld)", sleep_time);
 	if (sleep_time > 0xFFFFFFFFFFFF) sleep_time = 0xFFFFFFFFFFFF; //2^48-1
-	for (u32 i = 0; i < sleep_time / 1000000; i++)
+
+	PPUSchedulerBlock block;
+
+	if (!Emu.GetTimerManager().SleepUntil(get_system_time() + sleep_time))
 	{
-		std::this_thread::sleep_for(std::chrono::seconds(1));
-		if (Emu.IsStopped())
-		{
-			sys_timer.Warning("sys_timer_usleep(sleep_time=%lld) aborted", sleep_time);
-			return CELL_OK;
-		}
+		sys_timer.Warning("sys_timer_usleep(sleep_time=%lld) aborted", sleep_time);
 	}
-	std::this_thread::sleep_for(std::chrono::microseconds(sleep_time % 1000000));
+
 	return CELL_OK;
 }
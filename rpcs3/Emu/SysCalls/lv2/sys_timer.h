@@ -14,11 +14,31 @@ struct sys_timer_information_t
 	u32 pad;
 };
 
+struct EventQueue;
+
 struct timer
 {
+	std::mutex mutex; // protects timer_information_t and the connection
 	sys_timer_information_t timer_information_t;
+	std::weak_ptr<EventQueue> port; // connected event queue
+	u64 source;
+	u64 data1;
+	u64 data2;
+	std::atomic<u32> service_id; // TimerManager id of the running timer (0 if stopped)
+
+	timer()
+		: source(0)
+		, data1(0)
+		, data2(0)
+		, service_id(0)
+	{
+		memset(&timer_information_t, 0, sizeof(timer_information_t));
+	}
 };
 
+// stop the timer and wait for its callback if it's being executed
+void timer_stop(timer& timer_data);
+
 s32 sys_timer_create(vm::ptr<u32> timer_id);
 s32 sys_timer_destroy(u32 timer_id);
 s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> info);
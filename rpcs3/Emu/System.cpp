@@ -26,6 +26,7 @@
 #include "Emu/Audio/AudioManager.h"
 #include "Emu/FS/VFS.h"
 #include "Emu/SysCalls/SyncPrimitivesManager.h"
+#include "Emu/TimerManager.h"
 
 #include "Loader/PSF.h"
 
@@ -59,6 +60,7 @@ Emulator::Emulator()
 	, m_sfunc_manager(new StaticFuncManager())
 	, m_module_manager(new ModuleManager())
 	, m_sync_prim_manager(new SyncPrimManager())
+	, m_timer_manager(new TimerManager())
 	, m_vfs(new VFS())
 {
 	m_loader.register_handler(new loader::handlers::elf32);
@@ -79,6 +81,7 @@ Emulator::~Emulator()
 	delete m_sfunc_manager;
 	delete m_module_manager;
 	delete m_sync_prim_manager;
+	delete m_timer_manager;
 	delete m_vfs;
 }
 
@@ -293,6 +296,7 @@ void Emulator::Load()
 	GetCallbackManager().Init();
 	GetAudioManager().Init();
 	GetEventManager().Init();
+	GetTimerManager().Init();
 
 	SendDbgCommand(DID_READY_EMU);
 }
@@ -331,6 +335,9 @@ void Emulator::Pause()
 		SendDbgCommand(DID_PAUSED_EMU);
 
 		GetCallbackManager().RunPauseCallbacks(true);
+
+		// usually paused after an error, make the log complete
+		Log::LogManager::getInstance().flush();
 	}
 }
 
@@ -355,6 +362,12 @@ void Emulator::Stop()
 	SendDbgCommand(DID_STOP_EMU);
 	m_status = Stopped;
 
+	// wake up threads blocked in sleep queues
+	GetCPU().NotifyThreads();
+
+	// the timer thread is counted in g_thread_count too
+	GetTimerManager().Close();
+
 	while (g_thread_count)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -23,6 +23,7 @@ class EventManager;
 class ModuleManager;
 class StaticFuncManager;
 class SyncPrimManager;
+class TimerManager;
 struct VFS;
 
 struct EmuInfo
@@ -104,6 +105,7 @@ class Emulator
 	StaticFuncManager* m_sfunc_manager;
 	ModuleManager* m_module_manager;
 	SyncPrimManager* m_sync_prim_manager;
+	TimerManager* m_timer_manager;
 	VFS* m_vfs;
 
 	EmuInfo m_info;
@@ -167,6 +169,7 @@ public:
 	StaticFuncManager& GetSFuncManager()   { return *m_sfunc_manager; }
 	ModuleManager&    GetModuleManager()   { return *m_module_manager; }
 	SyncPrimManager&  GetSyncPrimManager() { return *m_sync_prim_manager; }
+	TimerManager&     GetTimerManager()    { return *m_timer_manager; }
 
 	void AddModuleInit(std::unique_ptr<ModuleInitializer> m)
 	{
@@ -0,0 +1,204 @@
+#include "stdafx.h"
+#include "Emu/System.h"
+#include "Emu/SysCalls/lv2/sys_time.h"
+#include "TimerManager.h"
+
+// the last part of a wait is done by yielding, OS timed waits aren't precise enough
+const u64 TIMER_SPIN_TIME = 200;
+
+// max time (in milliseconds) SleepUntil() waits without checking the emulator status
+const u64 TIMER_MAX_WAIT = 100;
+
+namespace
+{
+	// std heap functions build a max-heap, so compare in reverse order
+	bool TimerHeapLater(const std::pair<u64, u32>& a, const std::pair<u64, u32>& b)
+	{
+		return a.first > b.first;
+	}
+}
+
+TimerManager::TimerManager()
+	: m_next_id(0)
+	, m_stop(true)
+	, m_thread("Timer Thread")
+{
+}
+
+TimerManager::~TimerManager()
+{
+	Close();
+}
+
+void TimerManager::Init()
+{
+	Close();
+
+	m_stop = false;
+	m_thread.start([this](){ Task(); });
+}
+
+void TimerManager::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_stop = true;
+	}
+
+	m_cond.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_timers.clear();
+	m_heap.clear();
+}
+
+u32 TimerManager::Add(u64 deadline, u64 period, std::function<void(u64 next_deadline)> func)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const u32 id = ++m_next_id ? m_next_id : ++m_next_id;
+
+	TimerInfo& timer = m_timers[id];
+	timer.deadline = deadline;
+	timer.period = period;
+	timer.func = std::make_shared<std::function<void(u64)>>(std::move(func));
+
+	m_heap.push_back(std::make_pair(deadline, id));
+	std::push_heap(m_heap.begin(), m_heap.end(), TimerHeapLater);
+
+	m_cond.notify_one();
+	return id;
+}
+
+void TimerManager::Remove(u32 id)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_timers.erase(id);
+	}
+
+	// wait for the callback if it's being executed
+	std::lock_guard<std::recursive_mutex> lock(m_exec_mutex);
+}
+
+void TimerManager::Task()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (m_heap.empty())
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+
+		const u64 deadline = m_heap.front().first;
+		const u32 id = m_heap.front().second;
+
+		auto found = m_timers.find(id);
+
+		if (found == m_timers.end() || found->second.deadline != deadline)
+		{
+			std::pop_heap(m_heap.begin(), m_heap.end(), TimerHeapLater);
+			m_heap.pop_back();
+			continue;
+		}
+
+		const u64 now = get_system_time();
+
+		if (now + TIMER_SPIN_TIME < deadline)
+		{
+			m_cond.wait_for(lock, std::chrono::microseconds(deadline - now - TIMER_SPIN_TIME));
+			continue;
+		}
+
+		if (now < deadline)
+		{
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+			continue;
+		}
+
+		std::pop_heap(m_heap.begin(), m_heap.end(), TimerHeapLater);
+		m_heap.pop_back();
+
+		TimerInfo& timer = found->second;
+		const auto func = timer.func;
+		u64 next_deadline = 0;
+
+		if (timer.period)
+		{
+			// keep the phase, skip the periods which were missed completely
+			timer.deadline += timer.period;
+
+			if (timer.deadline <= now)
+			{
+				timer.deadline += ((now - timer.deadline) / timer.period + 1) * timer.period;
+			}
+
+			next_deadline = timer.deadline;
+			m_heap.push_back(std::make_pair(timer.deadline, id));
+			std::push_heap(m_heap.begin(), m_heap.end(), TimerHeapLater);
+		}
+		else
+		{
+			m_timers.erase(found);
+		}
+
+		std::unique_lock<std::recursive_mutex> exec_lock(m_exec_mutex);
+		lock.unlock();
+
+		(*func)(next_deadline);
+
+		exec_lock.unlock();
+		lock.lock();
+	}
+}
+
+bool TimerManager::SleepUntil(u64 deadline)
+{
+	NamedThreadBase* thread = GetCurrentNamedThread();
+
+	if (!thread)
+	{
+		const u64 now = get_system_time();
+
+		if (now < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(deadline - now));
+		}
+
+		return !Emu.IsStopped();
+	}
+
+	const u32 id = Add(deadline, 0, [thread](u64)
+	{
+		thread->Notify();
+	});
+
+	bool result = true;
+
+	while (get_system_time() < deadline)
+	{
+		if (Emu.IsStopped())
+		{
+			result = false;
+			break;
+		}
+
+		thread->WaitForAnySignal(TIMER_MAX_WAIT);
+	}
+
+	Remove(id);
+	return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <unordered_map>
+#include "Utilities/Thread.h"
+
+// executes callbacks at deadlines (in get_system_time() microseconds) on a single host thread
+// callbacks must be short and must not block: they usually push an event or wake up another thread
+class TimerManager
+{
+	struct TimerInfo
+	{
+		u64 deadline;
+		u64 period; // 0 for one-shot timers
+		std::shared_ptr<std::function<void(u64)>> func;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::recursive_mutex m_exec_mutex; // held while a callback is executed
+	std::unordered_map<u32, TimerInfo> m_timers;
+	std::vector<std::pair<u64, u32>> m_heap; // (deadline, id), stale entries of removed or rescheduled timers are skipped
+	u32 m_next_id;
+	bool m_stop;
+	thread_t m_thread;
+
+	void Task();
+
+public:
+	TimerManager();
+	~TimerManager();
+
+	void Init();
+	void Close();
+
+	// call func at deadline and then every period microseconds (if period isn't 0), returns the timer id
+	// func gets the next deadline (overdue periods are skipped), or 0 for one-shot timers
+	u32 Add(u64 deadline, u64 period, std::function<void(u64 next_deadline)> func);
+	// the callback isn't executed anymore after it returns (it can be called from the callback itself)
+	void Remove(u32 id);
+
+	// block the current thread until the deadline, returns false if the emulator was stopped
+	bool SleepUntil(u64 deadline);
+};
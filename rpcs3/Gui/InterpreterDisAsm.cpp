@@ -6,6 +6,7 @@
 #include "InterpreterDisAsm.h"
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/PPUDecoder.h"
+#include "Emu/Cell/PPUCachedDecoder.h"
 #include "Emu/Cell/PPUDisAsm.h"
 #include "Emu/Cell/SPUDecoder.h"
 #include "Emu/Cell/SPUDisAsm.h"
@@ -574,6 +575,7 @@ void InterpreterDisAsmFrame::AddBreakPoint(u64 pc)
 	}
 
 	Emu.GetBreakPoints().push_back(pc);
+	PPUPredecodedCache::Invalidate((u32)pc);
 }
 
 bool InterpreterDisAsmFrame::RemoveBreakPoint(u64 pc)
@@ -373,6 +373,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	// CPU/SPU settings
 	wxStaticBoxSizer* s_round_cpu_decoder = new wxStaticBoxSizer(wxVERTICAL, p_cpu, _("CPU"));
 	wxStaticBoxSizer* s_round_spu_decoder = new wxStaticBoxSizer(wxVERTICAL, p_cpu, _("SPU"));
+	wxStaticBoxSizer* s_round_ppu_threads = new wxStaticBoxSizer(wxVERTICAL, p_cpu, _("Max running PPU threads"));
 
 	// Graphics
 	wxStaticBoxSizer* s_round_gs_render = new wxStaticBoxSizer(wxVERTICAL, p_graphics, _("Render"));
@@ -400,6 +401,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 
 	wxComboBox* cbox_cpu_decoder      = new wxComboBox(p_cpu, wxID_ANY);
 	wxComboBox* cbox_spu_decoder      = new wxComboBox(p_cpu, wxID_ANY);
+	wxComboBox* cbox_ppu_threads      = new wxComboBox(p_cpu, wxID_ANY);
 	wxComboBox* cbox_gs_render        = new wxComboBox(p_graphics, wxID_ANY);
 	wxComboBox* cbox_gs_resolution    = new wxComboBox(p_graphics, wxID_ANY);
 	wxComboBox* cbox_gs_aspect        = new wxComboBox(p_graphics, wxID_ANY);
@@ -434,10 +436,14 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 
 	cbox_cpu_decoder->Append("PPU Interpreter");
 	cbox_cpu_decoder->Append("PPU JIT (LLVM)");
+	cbox_cpu_decoder->Append("PPU Interpreter (cached)");
 
 	cbox_spu_decoder->Append("SPU Interpreter");
 	cbox_spu_decoder->Append("SPU JIT (ASMJIT)");
 
+	cbox_ppu_threads->Append("Auto (host cores)");
+	for (int i = 1; i <= 16; i++) cbox_ppu_threads->Append(wxString::Format("%d", i));
+
 	cbox_gs_render->Append("Null");
 	cbox_gs_render->Append("OpenGL");
 	//cbox_gs_render->Append("Software");
@@ -528,6 +534,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 
 	cbox_cpu_decoder     ->SetSelection(Ini.CPUDecoderMode.GetValue() ? Ini.CPUDecoderMode.GetValue() - 1 : 0);
 	cbox_spu_decoder     ->SetSelection(Ini.SPUDecoderMode.GetValue() ? Ini.SPUDecoderMode.GetValue() - 1 : 0);
+	cbox_ppu_threads     ->SetSelection(std::min<int>(Ini.PPUThreadLimit.GetValue(), 16));
 	cbox_gs_render       ->SetSelection(Ini.GSRenderMode.GetValue());
 	cbox_gs_resolution   ->SetSelection(ResolutionIdToNum(Ini.GSResolution.GetValue()) - 1);
 	cbox_gs_aspect       ->SetSelection(Ini.GSAspectRatio.GetValue() - 1);
@@ -550,6 +557,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 
 	s_round_cpu_decoder->Add(cbox_cpu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_spu_decoder->Add(cbox_spu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_ppu_threads->Add(cbox_ppu_threads, wxSizerFlags().Border(wxALL, 5).Expand());
 
 	s_round_gs_render->Add(cbox_gs_render, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_gs_res->Add(cbox_gs_resolution, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -572,6 +580,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	// Core
 	s_subpanel_cpu->Add(s_round_cpu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_cpu->Add(s_round_spu_decoder, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_cpu->Add(s_round_ppu_threads, wxSizerFlags().Border(wxALL, 5).Expand());
 
 	// Graphics
 	s_subpanel_graphics->Add(s_round_gs_render, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -636,6 +645,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	{
 		Ini.CPUDecoderMode.SetValue(cbox_cpu_decoder->GetSelection() + 1);
 		Ini.SPUDecoderMode.SetValue(cbox_spu_decoder->GetSelection() + 1);
+		Ini.PPUThreadLimit.SetValue(cbox_ppu_threads->GetSelection());
 		Ini.GSRenderMode.SetValue(cbox_gs_render->GetSelection());
 		Ini.GSResolution.SetValue(ResolutionNumToId(cbox_gs_resolution->GetSelection() + 1));
 		Ini.GSAspectRatio.SetValue(cbox_gs_aspect->GetSelection() + 1);
@@ -99,6 +99,7 @@ public:
 	// Core
 	IniEntry<u8> CPUDecoderMode;
 	IniEntry<u8> SPUDecoderMode;
+	IniEntry<u8> PPUThreadLimit;
 
 	// Graphics
 	IniEntry<u8> GSRenderMode;
@@ -176,6 +177,7 @@ public:
 		// Core
 		CPUDecoderMode.Init("CPU_DecoderMode", path);
 		SPUDecoderMode.Init("CPU_SPUDecoderMode", path);
+		PPUThreadLimit.Init("CPU_PPUThreadLimit", path);
 
 		// Graphics
 		GSRenderMode.Init("GS_RenderMode", path);
@@ -249,6 +251,7 @@ public:
 		// Core
 		CPUDecoderMode.Load(1);
 		SPUDecoderMode.Load(1);
+		PPUThreadLimit.Load(0);
 
 		// Graphics
 		GSRenderMode.Load(1);
@@ -323,6 +326,7 @@ public:
 		// CPU/SPU
 		CPUDecoderMode.Save();
 		SPUDecoderMode.Save();
+		PPUThreadLimit.Save();
 
 		// Graphics
 		GSRenderMode.Save();